@@ -0,0 +1,55 @@
+# Memory pool benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/alloc_pool.rb VM_ALLOC=tlsf
+#
+# Each frame makes and drops short lived objects like a game loop does,
+# while a few long lived ones are kept. The elapsed frames, and the
+# statistics of the memory pool before and after, are drawn on the console.
+
+FRAMES = 300
+FPS = 60
+
+class Bullet
+  attr_reader :x, :y
+
+  def initialize(x, y)
+    @x = x
+    @y = y
+  end
+end
+
+def draw_statistics(y, label)
+  total, used, free, fragmentation = SNES.memory_statistics
+  SNES::Console.draw_text(1, y, label)
+  SNES::Console.draw_text(1, y + 1, " total: " + total.to_s + " used: " + used.to_s)
+  SNES::Console.draw_text(1, y + 2, " free: " + free.to_s + " frag: " + fragmentation.to_s)
+end
+
+draw_statistics(3, "before")
+
+kept = []
+max_fragmentation = 0
+start = SNES.frame_count
+FRAMES.times do |frame|
+  bullets = []
+  8.times do |i|
+    bullets << Bullet.new(frame, i * 16)
+  end
+  text = "frame " + frame.to_s
+  kept << [frame, text] if frame % 30 == 0
+
+  fragmentation = SNES.memory_statistics[3]
+  max_fragmentation = fragmentation if max_fragmentation < fragmentation
+end
+frames = SNES.frame_count - start
+
+SNES::Console.draw_text(1, 1, "memory pool benchmark")
+draw_statistics(7, "after")
+SNES::Console.draw_text(1, 11, "max frag: " + max_fragmentation.to_s)
+SNES::Console.draw_text(1, 12, "frames: " + frames.to_s)
+SNES::Console.draw_text(1, 13, "us/frame: " + (frames * (1000000 / FPS) / FRAMES).to_s)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,48 @@
+# Array growth benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/array_push.rb VM_ALLOC=tlsf
+#
+# An array of N integers is built with <<, LOOPS times, with and without
+# reserve. The elapsed frames, the capacity, and the peak used memory of
+# the pool are drawn on the console.
+
+N = 1024
+LOOPS = 10
+FPS = 60
+
+def used_memory
+  SNES.memory_statistics[1]
+end
+
+def measure(y, label, reserve)
+  base = used_memory
+  peak = 0
+  capacity = 0
+  start = SNES.frame_count
+  LOOPS.times do
+    ary = []
+    ary.reserve(N) if reserve
+    i = 0
+    while i < N
+      ary << i
+      i += 1
+    end
+    used = used_memory - base
+    peak = used if peak < used
+    capacity = ary.capacity
+  end
+  frames = SNES.frame_count - start
+
+  SNES::Console.draw_text(1, y, label)
+  SNES::Console.draw_text(1, y + 1, " ns/push: " + (frames * (1000000 / FPS) / LOOPS * 1000 / N).to_s)
+  SNES::Console.draw_text(1, y + 2, " capacity: " + capacity.to_s + " peak: " + peak.to_s)
+end
+
+SNES::Console.draw_text(1, 1, "Array#<< benchmark")
+measure(3, "push", false)
+measure(7, "reserve + push", true)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,38 @@
+# Default tile map benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/default_tile_map.rb VM_ALLOC=tlsf
+#
+# SNES::Bg.default_tile_maps returns a view of the tile map in ROM, which
+# is copied to the heap by the first write. The elapsed frames and the
+# used memory of the pool are drawn on the console, before and after
+# the first write.
+
+LOOPS = 100
+FPS = 60
+
+def used_memory
+  SNES.memory_statistics[1]
+end
+
+base = used_memory
+start = SNES.frame_count
+LOOPS.times do
+  SNES::Bg.default_tile_maps(1)
+end
+frames = SNES.frame_count - start
+
+tile_maps = SNES::Bg.default_tile_maps(1)
+view = used_memory - base
+tile_maps[0] = tile_maps[0]
+copied = used_memory - base
+
+SNES::Console.draw_text(1, 1, "default tile map benchmark")
+SNES::Console.draw_text(1, 3, "tiles: " + tile_maps.size.to_s)
+SNES::Console.draw_text(1, 4, "us/call: " + (frames * (1000000 / FPS) / LOOPS).to_s)
+SNES::Console.draw_text(1, 5, "view bytes: " + view.to_s)
+SNES::Console.draw_text(1, 6, "copied bytes: " + copied.to_s)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,48 @@
+# Frame arena benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/frame_arena.rb VM_FRAME_ARENA=1
+#
+# Build it again without VM_FRAME_ARENA=1 to compare the elapsed frames.
+# Each frame makes the temporaries a game loop does between
+# SNES.begin_frame and SNES.wait_for_vblank, and keeps a few of them.
+# The elapsed frames and the statistics of the frame arena are drawn on
+# the console.
+
+FRAMES = 300
+FPS = 60
+
+class Bullet
+  attr_reader :x, :y
+
+  def initialize(x, y)
+    @x = x
+    @y = y
+  end
+end
+
+kept = []
+start = SNES.frame_count
+FRAMES.times do |frame|
+  SNES.begin_frame
+  bullets = []
+  8.times do |i|
+    bullets << Bullet.new(frame, i * 16)
+  end
+  range = (0..frame)
+  text = "frame " + frame.to_s
+  kept << text if frame % 60 == 0
+  SNES.wait_for_vblank
+end
+frames = SNES.frame_count - start
+
+SNES::Console.draw_text(1, 1, "frame arena benchmark")
+SNES::Console.draw_text(1, 3, "frames: " + frames.to_s)
+SNES::Console.draw_text(1, 4, "us/frame: " + (frames * (1000000 / FPS) / FRAMES).to_s)
+alloc, overflow, promoted, chunks = SNES.frame_arena_statistics
+SNES::Console.draw_text(1, 6, "alloc: " + alloc.to_s + " overflow: " + overflow.to_s)
+SNES::Console.draw_text(1, 7, "promoted: " + promoted.to_s + " chunks: " + chunks.to_s)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,71 @@
+# Compressed IREP benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/inflate_irep.rb VM_PROFILE=load VM_COMPRESS=1
+#
+# mrbc_compress.rb reports the ROM size of each IREP at build time.
+# Here each IREP of this file is inflated LOOPS times, and the ROM size,
+# the RAM size and the elapsed frames are drawn on the console, followed
+# by the whole load time to compare with bench/load_mrb.rb.
+
+LOOPS = 100
+FPS = 60
+
+class Player
+  attr_accessor :x, :y, :width, :height
+
+  def initialize(x, y)
+    @x = x
+    @y = y
+    @width = 16
+    @height = 16
+    @velocity = 0
+    @frames = 0
+  end
+
+  def update(pad)
+    @frames += 1
+    @velocity = -6 if pad & 128 != 0
+    @velocity += 1 if @frames & 3 == 0
+    @y += @velocity
+    @y = 0 if @y < 0
+  end
+end
+
+class Score
+  attr_reader :value
+
+  def initialize
+    @value = 0
+    @best = 0
+  end
+
+  def add(n)
+    @value += n
+    @best = @value if @best < @value
+  end
+
+  def to_s
+    "score: " + @value.to_s + " best: " + @best.to_s
+  end
+end
+
+profile = SNES.inflate_profile(LOOPS)
+frames = SNES.benchmark_load(LOOPS)
+
+SNES::Console.draw_text(1, 1, "inflate IREP benchmark")
+SNES::Console.draw_text(1, 3, "irep  rom  ram us/inflate")
+y = 4
+profile.each_with_index do |entry, i|
+  rom, ram, elapsed = entry
+  SNES::Console.draw_text(1, y, i.to_s)
+  SNES::Console.draw_text(6, y, rom.to_s)
+  SNES::Console.draw_text(11, y, ram.to_s)
+  SNES::Console.draw_text(16, y, (elapsed * (1000000 / FPS) / LOOPS).to_s)
+  y += 1
+end
+SNES::Console.draw_text(1, y + 1, "us/load: " + (frames * (1000000 / FPS) / LOOPS).to_s)
+
+while true
+  SNES.wait_for_vblank
+end
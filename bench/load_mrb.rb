@@ -0,0 +1,93 @@
+# Boot-time benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/load_mrb.rb VM_PROFILE=load
+#
+# With VM_PRELINK=1, mrbc_load_prelinked() is measured instead.
+# With VM_COMPRESS=1, inflating is included. (see bench/inflate_irep.rb)
+#
+# mrbc_load_mrb() is run LOOPS times on the bytecode of this file, and the
+# elapsed frames are drawn on the console. The classes below only give the
+# loader a game-sized set of ireps and symbols to resolve.
+
+LOOPS = 100
+FPS = 60
+
+KEY_A = 128
+KEY_UP = 2048
+KEY_DOWN = 1024
+
+class BlockPair
+  WIDTH = 24
+
+  attr_reader :x, :y
+
+  def initialize(x, y)
+    @x = x
+    @y = y
+    @gap = 10 * 8
+  end
+
+  def collide?(player)
+    player.x + player.width > x && x + WIDTH > player.x &&
+      (player.y < y || y + @gap < player.y + player.height)
+  end
+
+  def scroll(dx)
+    @x -= dx
+  end
+end
+
+class Player
+  attr_accessor :x, :y, :width, :height
+
+  def initialize(x, y)
+    @x = x
+    @y = y
+    @width = 16
+    @height = 16
+    @velocity = 0
+    @frames = 0
+  end
+
+  def update(pad)
+    @frames += 1
+    @velocity = -6 if pad & KEY_A != 0
+    @velocity += 1 if @frames & 3 == 0
+    @y += @velocity
+    @y = 0 if @y < 0
+  end
+
+  def dead?(blocks)
+    blocks.any? { |block| block.collide?(self) }
+  end
+end
+
+class Score
+  attr_reader :value
+
+  def initialize
+    @value = 0
+    @best = 0
+  end
+
+  def add(n)
+    @value += n
+    @best = @value if @best < @value
+  end
+
+  def to_s
+    "score: " + @value.to_s + " best: " + @best.to_s
+  end
+end
+
+frames = SNES.benchmark_load(LOOPS)
+
+SNES::Console.draw_text(1, 1, "mrbc_load_mrb benchmark")
+SNES::Console.draw_text(1, 3, "loops:  " + LOOPS.to_s)
+SNES::Console.draw_text(1, 4, "frames: " + frames.to_s)
+SNES::Console.draw_text(1, 5, "us/load: " + (frames * (1000000 / FPS) / LOOPS).to_s)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,45 @@
+# Shadow OAM benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/oam_set_many.rb
+#
+# SPRITES sprites are moved LOOPS times, with SNES::OAM.set for each
+# sprite, and with one SNES::OAM.set_many. The elapsed frames are drawn
+# on the console.
+
+SPRITES = 64
+LOOPS = 100
+FPS = 60
+
+def measure(y, label, many)
+  records = U16Array.new(SPRITES * 7)
+  start = SNES.frame_count
+  LOOPS.times do |n|
+    i = 0
+    while i < SPRITES
+      x = (i * 4 + n) & 255
+      y0 = (i * 3) & 127
+      if many
+        records[i * 7] = x
+        records[i * 7 + 1] = y0
+        records[i * 7 + 2] = 3
+      else
+        SNES::OAM.set(i * 4, x, y0, 3, 0, 0, 0, 0)
+      end
+      i += 1
+    end
+    SNES::OAM.set_many(0, records) if many
+  end
+  frames = SNES.frame_count - start
+
+  SNES::Console.draw_text(1, y, label)
+  SNES::Console.draw_text(1, y + 1, " us/frame: " + (frames * (1000000 / FPS) / LOOPS).to_s)
+end
+
+SNES::Console.draw_text(1, 1, "shadow OAM benchmark")
+measure(3, "OAM.set", false)
+measure(6, "OAM.set_many", true)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,95 @@
+# Opcode frequency profile.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/opcode_profile.rb VM_PROFILE=opcodes
+#
+# The most executed opcodes and opcode pairs are drawn on the console.
+# Pairs are counted in execution order, so a taken jump also makes a pair
+# with its target. Add VM_SUPERINSTRUCTIONS=1 to see which of them are
+# fused. The workload below follows the inner loops of src/main.rb.
+
+BLOCK_MAP = [
+  [160, 161, 165],
+  [32, 33, 37],
+  [32, 33, 37],
+]
+
+class BlockPair
+  attr_reader :x, :y
+
+  def initialize(x, y)
+    @x = x
+    @y = y
+    @gap = 10 * 8
+  end
+
+  def render(tile_maps, offset_tiles)
+    block_tile_x = x / 8
+    upper_block_tile_y = y / 8 - 1
+
+    i = 0
+    while 0 <= upper_block_tile_y - i
+      map_y = i < BLOCK_MAP.size ? i : BLOCK_MAP.size - 1
+
+      j = 0
+      while j < BLOCK_MAP[map_y].size
+        tile_maps[32 * (upper_block_tile_y - i) + j + block_tile_x - offset_tiles] = BLOCK_MAP[map_y][j]
+        j += 1
+      end
+      i += 1
+    end
+  end
+end
+
+class Player
+  attr_accessor :x, :y
+
+  def initialize(x, y)
+    @x = x
+    @y = y
+    @frames = 0
+  end
+
+  def step(pad)
+    @frames += 1
+    @y += 2 if pad & 128 != 0
+    @x = (@x + 300) & 0xff
+  end
+end
+
+def run(frames)
+  tile_maps = Array.new(32 * 32, 18)
+  block = BlockPair.new(64, 96)
+  player = Player.new(32, 104)
+  camera_x = 0
+
+  frame = 0
+  while frame < frames
+    player.step(frame)
+    camera_x += 2
+    block.render(tile_maps, 0) if camera_x & 7 == 0
+    frame += 1
+  end
+end
+
+SNES.clear_opcode_profile
+run(60)
+
+SNES::Console.draw_text(1, 1, "opcode")
+row = 2
+SNES.opcode_profile(10).each do |name, count|
+  SNES::Console.draw_text(1, row, name + " " + count.to_s)
+  row += 1
+end
+
+SNES::Console.draw_text(1, 13, "opcode pair")
+row = 14
+SNES.opcode_pair_profile(12).each do |name, count|
+  SNES::Console.draw_text(1, row, name + " " + count.to_s)
+  row += 1
+end
+SNES::Console.draw_text(1, row, "dropped pairs " + SNES.opcode_pair_dropped.to_s)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,45 @@
+# Packed tile map benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/packed_array.rb VM_ALLOC=tlsf
+#
+# A 32x32 tile map is filled and uploaded to VRAM LOOPS times, once as an
+# Array of Integer and once as a U16Array. The elapsed frames and the used
+# memory of the pool for one tile map are drawn on the console.
+
+LOOPS = 20
+FPS = 60
+TILES = 32 * 32
+
+def used_memory
+  SNES.memory_statistics[1]
+end
+
+def measure(y, label, cls)
+  base = used_memory
+  tile_maps = cls.new(TILES, 18)
+  size = used_memory - base
+
+  start = SNES.frame_count
+  LOOPS.times do |n|
+    i = 0
+    while i < TILES
+      tile_maps[i] = (i + n) & 31
+      i += 1
+    end
+    SNES::Bg.update_tile_map(1, 0, tile_maps)
+  end
+  frames = SNES.frame_count - start
+
+  SNES::Console.draw_text(1, y, label)
+  SNES::Console.draw_text(1, y + 1, " us/map: " + (frames * (1000000 / FPS) / LOOPS).to_s)
+  SNES::Console.draw_text(1, y + 2, " bytes: " + size.to_s)
+end
+
+SNES::Console.draw_text(1, 1, "tile map benchmark")
+measure(3, "Array", Array)
+measure(7, "U16Array", U16Array)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,35 @@
+# S-CPU command ring benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/s_cpu_ring.rb
+#
+# SNES::OAM.set and SNES::Bg.scroll are queued to S-CPU without waiting,
+# and SNES::Pad.current waits for the queued commands. The elapsed frames
+# of CALLS queued calls, and of CALLS calls each followed by a waiting
+# call, are drawn on the console.
+
+CALLS = 1000
+FPS = 60
+
+def measure(y, label, wait)
+  start = SNES.frame_count
+  i = 0
+  while i < CALLS
+    SNES::OAM.set(0, i & 255, 100, 3, 0, 0, 0, 0)
+    SNES::Bg.scroll(2, i & 255, 0)
+    SNES::Pad.current(0) if wait
+    i += 1
+  end
+  frames = SNES.frame_count - start
+
+  SNES::Console.draw_text(1, y, label)
+  SNES::Console.draw_text(1, y + 1, " ns/call: " + (frames * (1000000 / FPS) / CALLS * 1000).to_s)
+end
+
+SNES::Console.draw_text(1, 1, "S-CPU command ring benchmark")
+measure(3, "queued", false)
+measure(6, "queued + wait", true)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,50 @@
+# Slab allocator benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/slab_alloc.rb VM_SLAB=1
+#
+# Build it again without VM_SLAB=1 to compare the elapsed frames.
+# Each frame makes and drops the small objects a game loop does, and the
+# elapsed frames and the hit/miss counts of each size class are drawn on
+# the console.
+
+FRAMES = 300
+FPS = 60
+
+class Bullet
+  attr_reader :x, :y
+
+  def initialize(x, y)
+    @x = x
+    @y = y
+  end
+end
+
+start = SNES.frame_count
+FRAMES.times do |frame|
+  bullets = []
+  8.times do |i|
+    bullets << Bullet.new(frame, i * 16)
+  end
+  range = (0..frame)
+  text = "frame " + frame.to_s
+end
+frames = SNES.frame_count - start
+
+SNES::Console.draw_text(1, 1, "slab allocator benchmark")
+SNES::Console.draw_text(1, 3, "frames: " + frames.to_s)
+SNES::Console.draw_text(1, 4, "us/frame: " + (frames * (1000000 / FPS) / FRAMES).to_s)
+SNES::Console.draw_text(1, 6, "size    hit   miss")
+y = 7
+SNES.slab_statistics.each do |entry|
+  size, hit, miss = entry
+  next if hit == 0 && miss == 0
+  SNES::Console.draw_text(1, y, size.to_s)
+  SNES::Console.draw_text(6, y, hit.to_s)
+  SNES::Console.draw_text(13, y, miss.to_s)
+  y += 1
+end
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,37 @@
+# Tile map upload benchmark.
+#
+# Build and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/tile_map_upload.rb
+#
+# A tile of the tile map of BG 1 is changed every frame, and the whole
+# map is passed to SNES::Bg.update_tile_map. Only the changed row is
+# uploaded in SNES.wait_for_vblank. The uploaded and requested bytes of
+# the tile map per frame, and the elapsed frames, are drawn on the console.
+
+FRAMES = 120
+FPS = 60
+
+tile_maps = SNES::Bg.default_tile_maps(1)
+uploaded = 0
+requested = 0
+
+start = SNES.frame_count
+FRAMES.times do |frame|
+  tile_maps[32 * (frame & 31) + 5] = frame & 1 == 0 ? 18 : 19
+  SNES::Bg.update_tile_map(1, 0, tile_maps)
+  SNES.wait_for_vblank
+
+  stat = SNES::Bg.upload_statistics
+  uploaded += stat[0]
+  requested += stat[1]
+end
+frames = SNES.frame_count - start
+
+SNES::Console.draw_text(1, 1, "tile map upload benchmark")
+SNES::Console.draw_text(1, 3, "uploaded/frame: " + (uploaded / FRAMES).to_s)
+SNES::Console.draw_text(1, 4, "requested/frame: " + (requested / FRAMES).to_s)
+SNES::Console.draw_text(1, 5, "us/frame: " + (frames * (1000000 / FPS) / FRAMES).to_s)
+
+while true
+  SNES.wait_for_vblank
+end
@@ -0,0 +1,49 @@
+# VM dispatch benchmark.
+#
+# Build with each dispatch mode and run the ROM on an emulator:
+#   make clean && make RUBY_MAIN=bench/vm_dispatch.rb VM_PROFILE=1
+#   make clean && make RUBY_MAIN=bench/vm_dispatch.rb VM_PROFILE=1 VM_DISPATCH=threaded
+#
+# The number of executed instructions per second is drawn on the console.
+
+FPS = 60
+
+class Counter
+  attr_reader :count
+
+  def initialize
+    @count = 0
+  end
+
+  def step(n)
+    @count += n
+  end
+end
+
+def run_loop(n)
+  counter = Counter.new
+  values = [1, 2, 3, 4]
+  i = 0
+  while i < n
+    counter.step(values[i & 3])
+    i += 1
+  end
+  counter.count
+end
+
+start_frame = SNES.frame_count
+start_inst = SNES.instruction_count
+result = run_loop(2000)
+insts = SNES.instruction_count - start_inst
+frames = (SNES.frame_count - start_frame) & 0xffff
+frames = 1 if frames == 0
+
+SNES::Console.draw_text(1, 1, "VM dispatch benchmark")
+SNES::Console.draw_text(1, 3, "result: " + result.to_s)
+SNES::Console.draw_text(1, 4, "frames: " + frames.to_s)
+SNES::Console.draw_text(1, 5, "insts:  " + insts.to_s)
+SNES::Console.draw_text(1, 6, "ips:    " + (insts / frames * FPS).to_s)
+
+while true
+  SNES.wait_for_vblank
+end
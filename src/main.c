@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include "bg.h"
+#include "snesw.h"
 
 // extern char patterns, patterns_end;
 // extern char palette;
@@ -54,6 +55,7 @@ int main(void) {
 
   while (1) {
     listen_call_from_sa1();
+    snesw_ring_drain();
   }
   return 0;
 }
@@ -76,7 +76,7 @@ end
 
 # @param [Array<BlockPair>] block_pairs
 # @param [Integer] offset
-# @param [Array<Integer>] tile_maps
+# @param [U16Array] tile_maps
 def render_block_pairs(block_pairs, offset, tile_maps)
   i = 0
   while i < block_pairs.size
@@ -103,12 +103,12 @@ def generate_block_pairs
       x += step
     end
 
-    tile_maps = Array.new(32 * 32, 18)
+    tile_maps = U16Array.new(32 * 32, 18)
     offset = tile_maps.size * i
     render_block_pairs(tmp, offset, tile_maps)
     SNES::Bg.update_tile_map(1, offset, tile_maps)
 
-    res += tmp
+    res.concat(tmp)
 
     i += 1
   end
@@ -155,6 +155,7 @@ current_block = block_pairs.first
 game_state = :running
 
 while true
+  SNES.begin_frame
   SNES::Pad.wait_for_scan
   pad = SNES::Pad.current(0)
 
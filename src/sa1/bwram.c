@@ -0,0 +1,19 @@
+#include <snes.h>
+
+#include "bwram.h"
+
+// Same as sa1_malloc(), but returns NULL if the block overlaps the memory
+// pool of mruby/c.
+void *bwram_alloc(unsigned int size) {
+  u8 *p = sa1_malloc(size);
+
+#if !defined(MRBC_ALLOC_LIBC)
+  if (p != NULL && p + size > (u8 *)MRBC_MEMORY_POOL_ADDR &&
+      p < (u8 *)MRBC_MEMORY_POOL_ADDR + MRBC_MEMORY_POOL_SIZE) {
+    sa1_free(p);
+    return NULL;
+  }
+#endif
+
+  return p;
+}
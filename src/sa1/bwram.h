@@ -0,0 +1,39 @@
+#ifndef BWRAM_H_
+#define BWRAM_H_
+
+#include <snes.h>
+
+// BW-RAM is 128KB at $40:0000 - $41:ffff. (SRAMSIZE $07 in hdr.asm)
+// It is seen at the same address from S-CPU.
+//
+//   $40:0000 - $40:ffff  heap of sa1_malloc(), placed by pvsneslib.
+//   $41:0000 - $41:fffb  memory pool of mruby/c, with VM_ALLOC=tlsf.
+//                        (VM_ALLOC_POOL and VM_ALLOC_POOL_SIZE)
+//
+// Without VM_ALLOC=tlsf, mruby/c uses the heap of sa1_malloc() and BW-RAM
+// has no pool. sa1_malloc() doesn't know the pool, so the SNES classes
+// allocate by bwram_alloc(), which checks that the block is out of it.
+#define BWRAM_ADDR 0x400000
+#define BWRAM_SIZE 0x20000
+
+#if !defined(MRBC_ALLOC_LIBC)
+#if !defined(MRBC_MEMORY_POOL_ADDR)
+#define MRBC_MEMORY_POOL_ADDR 0x410000
+#endif
+#if !defined(MRBC_MEMORY_POOL_SIZE)
+#define MRBC_MEMORY_POOL_SIZE 0xfffc
+#endif
+
+#if MRBC_MEMORY_POOL_ADDR < BWRAM_ADDR || \
+    MRBC_MEMORY_POOL_ADDR + MRBC_MEMORY_POOL_SIZE > BWRAM_ADDR + BWRAM_SIZE
+#error "The memory pool of mruby/c is out of BW-RAM."
+#endif
+// the size of a block is an unsigned int (16 bits) in the pool.
+#if (MRBC_MEMORY_POOL_ADDR & 0xffff) + MRBC_MEMORY_POOL_SIZE > 0x10000
+#error "The memory pool of mruby/c crosses a bank boundary."
+#endif
+#endif
+
+void *bwram_alloc(unsigned int size);
+
+#endif  // BWRAM_H_
@@ -6,20 +6,280 @@
 #include "c_snes/c_pad.h"
 #include "c_snes/c_spc.h"
 #include "sa1/mrubyc/mrubyc.h"
+#include "sa1/ring.h"
+#include "snesw.h"
 
 static void c_snes_wait_for_vblank(mrbc_vm *vm, mrbc_value v[], int argc) {
+  snes_bg_flush();
+  snes_oam_flush();
+  // the queued commands of the frame are not left to the next call_s_cpu().
+  snes_ring_flush();
+#if defined(MRBC_USE_FRAME_ARENA)
+  mrbc_frame_arena_end();
+#endif
   // call_s_cpu(WaitForVBlank, 0);
 }
 
+// Objects allocated from here to the next SNES.wait_for_vblank come from
+// the frame arena. Does nothing without MRBC_USE_FRAME_ARENA.
+static void c_snes_begin_frame(mrbc_vm *vm, mrbc_value v[], int argc) {
+#if defined(MRBC_USE_FRAME_ARENA)
+  mrbc_frame_arena_begin();
+#endif
+}
+
 static void c_snes_rand(mrbc_vm *vm, mrbc_value v[], int argc) {
   SET_INT_RETURN(rand() % v[1].i);
 }
 
+static u16 frame_count(void) {
+  u16 res;
+  u16 *dst = (void *)((uint32_t)&res + I_RAM_OFFSET);
+  call_s_cpu(snesw_frame_count, sizeof(void *), dst);
+
+  return res;
+}
+
+static void c_snes_frame_count(mrbc_vm *vm, mrbc_value v[], int argc) {
+  SET_INT_RETURN(frame_count());
+}
+
+#if !defined(MRBC_ALLOC_LIBC)
+// [total, used, free, fragmentation] of the memory pool.
+static void c_snes_memory_statistics(mrbc_vm *vm, mrbc_value v[], int argc) {
+  struct MRBC_ALLOC_STATISTICS mem;
+  mrbc_alloc_statistics(&mem);
+
+  mrbc_value ret = mrbc_array_new(vm, 4);
+  mrbc_value total = mrbc_integer_value(mem.total);
+  mrbc_value used = mrbc_integer_value(mem.used);
+  mrbc_value free_size = mrbc_integer_value(mem.free);
+  mrbc_value fragmentation = mrbc_integer_value(mem.fragmentation);
+  mrbc_array_push(&ret, &total);
+  mrbc_array_push(&ret, &used);
+  mrbc_array_push(&ret, &free_size);
+  mrbc_array_push(&ret, &fragmentation);
+
+  SET_RETURN(ret);
+}
+#endif
+
+#if defined(MRBC_USE_SLAB_ALLOC)
+// [[object size, hit, miss], ...] of each size class of the slab.
+static void c_snes_slab_statistics(mrbc_vm *vm, mrbc_value v[], int argc) {
+  struct MRBC_ALLOC_STATISTICS mem;
+  mrbc_alloc_statistics(&mem);
+
+  mrbc_value ret = mrbc_array_new(vm, MRBC_SLAB_CLASSES);
+  int i;
+  for (i = 0; i < MRBC_SLAB_CLASSES; i++) {
+    mrbc_value entry = mrbc_array_new(vm, 3);
+    mrbc_value size = mrbc_integer_value(mem.slab[i].size);
+    mrbc_value hit = mrbc_integer_value(mem.slab[i].hit);
+    mrbc_value miss = mrbc_integer_value(mem.slab[i].miss);
+    mrbc_array_push(&entry, &size);
+    mrbc_array_push(&entry, &hit);
+    mrbc_array_push(&entry, &miss);
+    mrbc_array_push(&ret, &entry);
+  }
+
+  SET_RETURN(ret);
+}
+#endif
+
+#if defined(MRBC_USE_FRAME_ARENA)
+// [alloc, overflow, promoted, chunks] of the frame arena.
+static void c_snes_frame_arena_statistics(mrbc_vm *vm, mrbc_value v[],
+                                          int argc) {
+  struct MRBC_FRAME_ARENA_STATISTICS stat;
+  mrbc_frame_arena_statistics(&stat);
+
+  mrbc_value ret = mrbc_array_new(vm, 4);
+  mrbc_value alloc = mrbc_integer_value(stat.alloc);
+  mrbc_value overflow = mrbc_integer_value(stat.overflow);
+  mrbc_value promoted = mrbc_integer_value(stat.promoted);
+  mrbc_value chunks = mrbc_integer_value(stat.chunks);
+  mrbc_array_push(&ret, &alloc);
+  mrbc_array_push(&ret, &overflow);
+  mrbc_array_push(&ret, &promoted);
+  mrbc_array_push(&ret, &chunks);
+
+  SET_RETURN(ret);
+}
+#endif
+
+#if defined(MRBC_COUNT_INSTRUCTIONS)
+static void c_snes_instruction_count(mrbc_vm *vm, mrbc_value v[], int argc) {
+  SET_INT_RETURN(vm->inst_count);
+}
+#endif
+
+#if defined(MRBC_PROFILE_OPCODES)
+#define OPCODE_PROFILE_MAX 16
+
+// [[name, count], ...] in descending order of count.
+static void opcode_profile(mrbc_vm *vm, mrbc_value v[], int argc,
+                           int flag_pair) {
+  uint16_t ops[OPCODE_PROFILE_MAX];
+  uint32_t counts[OPCODE_PROFILE_MAX];
+  int n = OPCODE_PROFILE_MAX;
+  if (argc >= 1 && mrbc_type(v[1]) == MRBC_TT_INTEGER && v[1].i < n) {
+    n = v[1].i;
+  }
+  n = mrbc_get_opcode_profile(flag_pair, n, ops, counts);
+
+  mrbc_value ret = mrbc_array_new(vm, n);
+  int i;
+  for (i = 0; i < n; i++) {
+    mrbc_value name;
+    if (flag_pair) {
+      name = mrbc_string_new_cstr(vm, mrbc_opcode_name(ops[i] >> 8));
+      mrbc_string_append_cstr(&name, "+");
+      mrbc_string_append_cstr(&name, mrbc_opcode_name(ops[i] & 0xff));
+    } else {
+      name = mrbc_string_new_cstr(vm, mrbc_opcode_name(ops[i]));
+    }
+
+    mrbc_value entry = mrbc_array_new(vm, 2);
+    mrbc_value count = mrbc_integer_value(counts[i]);
+    mrbc_array_push(&entry, &name);
+    mrbc_array_push(&entry, &count);
+    mrbc_array_push(&ret, &entry);
+  }
+
+  SET_RETURN(ret);
+}
+
+static void c_snes_opcode_profile(mrbc_vm *vm, mrbc_value v[], int argc) {
+  opcode_profile(vm, v, argc, 0);
+}
+
+static void c_snes_opcode_pair_profile(mrbc_vm *vm, mrbc_value v[],
+                                       int argc) {
+  opcode_profile(vm, v, argc, 1);
+}
+
+// executed opcode pairs not counted, because the pair table was full.
+static void c_snes_opcode_pair_dropped(mrbc_vm *vm, mrbc_value v[],
+                                       int argc) {
+  SET_INT_RETURN(mrbc_get_opcode_pair_dropped());
+}
+
+static void c_snes_clear_opcode_profile(mrbc_vm *vm, mrbc_value v[],
+                                        int argc) {
+  mrbc_clear_opcode_profile();
+}
+#endif
+
+#if defined(MRBC_PROFILE_LOAD)
+#if defined(MRBC_USE_PRELINK)
+// pre-linked IREP of RUBY_MAIN. (main.rb.prelinked.c)
+extern const mrbc_prelinked mrbbuf_prelinked;
+#else
+// bytecode of RUBY_MAIN. (main.rb.bytecode.c)
+extern const uint8_t mrbbuf[];
+#endif
+
+// Load the bytecode n times and return the elapsed frames.
+static void c_snes_benchmark_load(mrbc_vm *vm, mrbc_value v[], int argc) {
+  mrbc_irep *top_irep = vm->top_irep;
+  int n = v[1].i;
+  int i;
+
+  u16 start = frame_count();
+  for (i = 0; i < n; i++) {
+#if defined(MRBC_USE_PRELINK)
+    if (mrbc_load_prelinked(vm, &mrbbuf_prelinked) != 0) {
+      break;
+    }
+#else
+    if (mrbc_load_mrb(vm, mrbbuf) != 0) {
+      break;
+    }
+    mrbc_irep_free(vm->top_irep);
+#endif
+  }
+  u16 frames = frame_count() - start;
+
+  vm->top_irep = top_irep;
+  SET_INT_RETURN(frames);
+}
+
+#if defined(MRBC_USE_COMPRESSED_IREP) && !defined(MRBC_USE_PRELINK)
+// Inflate each IREP n times.
+// [[rom size, ram size, frames], ...] in order of the IREP records.
+static void c_snes_inflate_profile(mrbc_vm *vm, mrbc_value v[], int argc) {
+  int n = v[1].i;
+  mrbc_value ret = mrbc_array_new(vm, 0);
+  const void *block;
+  int rom_size, ram_size;
+  int i, j;
+
+  for (i = 0;
+       (block = mrbc_compressed_irep_block(mrbbuf, i, &rom_size, &ram_size));
+       i++) {
+    uint8_t *buf = mrbc_raw_alloc(ram_size);
+    if (!buf) {
+      break;
+    }
+
+    u16 start = frame_count();
+    for (j = 0; j < n; j++) {
+      mrbc_inflate_irep_block(block, buf);
+    }
+    u16 frames = frame_count() - start;
+    mrbc_raw_free(buf);
+
+    mrbc_value entry = mrbc_array_new(vm, 3);
+    mrbc_value rom = mrbc_integer_value(rom_size);
+    mrbc_value ram = mrbc_integer_value(ram_size);
+    mrbc_value elapsed = mrbc_integer_value(frames);
+    mrbc_array_push(&entry, &rom);
+    mrbc_array_push(&entry, &ram);
+    mrbc_array_push(&entry, &elapsed);
+    mrbc_array_push(&ret, &entry);
+  }
+
+  SET_RETURN(ret);
+}
+#endif
+#endif
+
 void snes_init_class_snes(struct VM *vm) {
   mrbc_class *cls = mrbc_define_class(vm, "SNES", NULL);
 
   mrbc_define_method(vm, cls, "wait_for_vblank", c_snes_wait_for_vblank);
+  mrbc_define_method(vm, cls, "begin_frame", c_snes_begin_frame);
   mrbc_define_method(vm, cls, "rand", c_snes_rand);
+  mrbc_define_method(vm, cls, "frame_count", c_snes_frame_count);
+#if !defined(MRBC_ALLOC_LIBC)
+  mrbc_define_method(vm, cls, "memory_statistics", c_snes_memory_statistics);
+#endif
+#if defined(MRBC_USE_SLAB_ALLOC)
+  mrbc_define_method(vm, cls, "slab_statistics", c_snes_slab_statistics);
+#endif
+#if defined(MRBC_USE_FRAME_ARENA)
+  mrbc_define_method(vm, cls, "frame_arena_statistics",
+                     c_snes_frame_arena_statistics);
+#endif
+#if defined(MRBC_COUNT_INSTRUCTIONS)
+  mrbc_define_method(vm, cls, "instruction_count", c_snes_instruction_count);
+#endif
+#if defined(MRBC_PROFILE_OPCODES)
+  mrbc_define_method(vm, cls, "opcode_profile", c_snes_opcode_profile);
+  mrbc_define_method(vm, cls, "opcode_pair_profile",
+                     c_snes_opcode_pair_profile);
+  mrbc_define_method(vm, cls, "opcode_pair_dropped",
+                     c_snes_opcode_pair_dropped);
+  mrbc_define_method(vm, cls, "clear_opcode_profile",
+                     c_snes_clear_opcode_profile);
+#endif
+#if defined(MRBC_PROFILE_LOAD)
+  mrbc_define_method(vm, cls, "benchmark_load", c_snes_benchmark_load);
+#if defined(MRBC_USE_COMPRESSED_IREP) && !defined(MRBC_USE_PRELINK)
+  mrbc_define_method(vm, cls, "inflate_profile", c_snes_inflate_profile);
+#endif
+#endif
 
   snes_init_class_bg(vm, cls);
   snes_init_class_console(vm, cls);
@@ -1,6 +1,9 @@
 #include <snes.h>
+#include <string.h>
 
+#include "sa1/bwram.h"
 #include "sa1/mrubyc/mrubyc.h"
+#include "sa1/ring.h"
 #include "snesw.h"
 
 static void c_snes_bg_scroll(mrbc_vm *vm, mrbc_value v[], int argc) {
@@ -15,8 +18,11 @@ static void c_snes_bg_scroll(mrbc_vm *vm, mrbc_value v[], int argc) {
   //   return;
   // }
 
-  call_s_cpu(bgSetScroll, sizeof(u8) + sizeof(u16) * 2, (u8)v[1].i, (u16)v[2].i,
-             (u16)v[3].i);
+  volatile snesw_command *c = snes_ring_reserve(SNESW_COMMAND_BG_SCROLL);
+  c->b[0] = v[1].i;
+  c->w[0] = v[2].i;
+  c->w[1] = v[3].i;
+  snes_ring_commit();
 }
 
 static const u16 *default_tile_maps[4];
@@ -27,20 +33,161 @@ static void c_snes_bg_get_default_tile_map(mrbc_vm *vm, mrbc_value v[],
                                            int argc) {
   const int bg = v[1].i;
   const size_t n = default_tile_map_sizes[bg] / 2;
-  mrbc_value res = mrbc_array_new(vm, n);
 
-  int i;
-  for (i = 0; i < n; i++) {
-    mrbc_array_set(&res, i, &mrbc_integer_value(default_tile_maps[bg][i]));
-  }
+  // A view of ROM. It is copied to the heap on the first write.
+  mrbc_value res = mrbc_packed_array_new_rom(vm, MRBC_CLASS(U16Array),
+                                             default_tile_maps[bg], n);
 
   SET_RETURN(res);
 }
 
+// words of a row of the tile map, the unit of the dirty bits.
+#define TILE_MAP_ROW 32
+
+// bytes DMA can move in a VBlank of NTSC, about 5.7KB.
+#define SNES_VBLANK_DMA_BYTES 5700
+
+// VBlank time not left for the tile maps, in bytes of DMA: the NMI handler
+// of pvsneslib, which runs before WaitForVBlank() returns, and the setup of
+// the spans.
+#define SNES_VBLANK_RESERVED_BYTES 1536
+
+// max bytes uploaded in a VBlank, 3584 by default. The rest is left dirty
+// for the next. pvsneslib uploads OAM in every VBlank, so it is counted too.
+#if !defined(SNES_BG_UPLOAD_MAX)
+#define SNES_BG_UPLOAD_MAX                                                 \
+  ((SNES_VBLANK_DMA_BYTES - SNESW_OAM_SIZE - SNES_VBLANK_RESERVED_BYTES) & \
+   ~(TILE_MAP_ROW * 2 - 1))
+#endif
+
+// max spans uploaded in a VBlank.
+#define SNES_BG_UPLOAD_SPANS 8
+
+// Copy of the tile map in VRAM, for the BG which has a default tile map.
+// Only the rows changed by update_tile_map are uploaded, in
+// snes_bg_flush(). A row is copied from the default tile map in ROM at
+// its first write, so the first update_tile_map doesn't copy the whole map.
+typedef struct {
+  u16 *tiles;
+  u8 *dirty;   // a bit for each row.
+  u8 *copied;  // a bit for each row. the row is copied from ROM.
+  u16 rows;
+} tile_map_shadow;
+
+static tile_map_shadow shadows[4];
+static snesw_vram_span *spans;
+
+// bytes requested by update_tile_map, and uploaded by snes_bg_flush().
+static u16 requested_bytes;
+static u16 last_requested_bytes;
+static u16 last_uploaded_bytes;
+
+// Returns the shadow of bg, which is the same as the default tile map loaded
+// to VRAM at first, or NULL if bg has no default tile map or ENOMEM.
+static tile_map_shadow *get_shadow(int bg) {
+  if (bg < 0 || bg >= 4) {
+    return NULL;
+  }
+
+  tile_map_shadow *s = &shadows[bg];
+  if (s->tiles != NULL) {
+    return s;
+  }
+  if (default_tile_maps[bg] == NULL) {
+    return NULL;
+  }
+
+  const u16 rows = default_tile_map_sizes[bg] / (TILE_MAP_ROW * 2);
+  const u16 bits = (rows + 7) / 8;
+  u16 *tiles = bwram_alloc(rows * TILE_MAP_ROW * 2);
+  if (tiles == NULL) {
+    return NULL;
+  }
+  u8 *flags = bwram_alloc(bits * 2);
+  if (flags == NULL) {
+    sa1_free(tiles);
+    return NULL;
+  }
+
+  memset(flags, 0, bits * 2);
+  s->tiles = tiles;
+  s->dirty = flags;
+  s->copied = flags + bits;
+  s->rows = rows;
+
+  return s;
+}
+
+// Writes n tiles to the shadow at offset, and marks the changed rows dirty.
+static void update_shadow(tile_map_shadow *s, int bg, u16 offset,
+                          const mrbc_value *tiles, u16 n) {
+  const mrbc_packed_array *packed = mrbc_to_packed_array(tiles);
+
+  u16 i;
+  for (i = 0; i < n; i++) {
+    const u16 tile = packed != NULL ? mrbc_packed_array_get(packed, i)
+                                    : tiles->array->data[i].i;
+    const u16 w = offset + i;
+    const u16 row = w / TILE_MAP_ROW;
+
+    if (!(s->copied[row / 8] & (1 << (row % 8)))) {
+      memcpy(&s->tiles[row * TILE_MAP_ROW],
+             &default_tile_maps[bg][row * TILE_MAP_ROW], TILE_MAP_ROW * 2);
+      s->copied[row / 8] |= 1 << (row % 8);
+    }
+
+    if (s->tiles[w] != tile) {
+      s->tiles[w] = tile;
+      s->dirty[row / 8] |= 1 << (row % 8);
+    }
+  }
+}
+
 static void c_snes_bg_update_tile_map(mrbc_vm *vm, mrbc_value v[], int argc) {
   const int bg = v[1].i;
   const u16 offset = v[2].i;
-  const size_t n = v[3].array->n_stored;
+  if (bg < 0 || bg >= 4) {
+    mrbc_raise(vm, MRBC_CLASS(ArgumentError), 0);
+    return;
+  }
+  const mrbc_packed_array *tiles = mrbc_to_packed_array(&v[3]);
+  if (tiles == NULL && mrbc_type(v[3]) != MRBC_TT_ARRAY) {
+    mrbc_raise(vm, MRBC_CLASS(ArgumentError), 0);
+    return;
+  }
+  const size_t n = tiles != NULL ? tiles->size : v[3].array->n_stored;
+  if (tiles == NULL) {
+    int i;
+    for (i = 0; i < n; i++) {
+      if (mrbc_type(v[3].array->data[i]) != MRBC_TT_INTEGER) {
+        mrbc_raise(vm, MRBC_CLASS(TypeError), 0);
+        return;
+      }
+    }
+  }
+
+  // merged in the shadow, and uploaded in SNES.wait_for_vblank.
+  tile_map_shadow *s = get_shadow(bg);
+  if (s != NULL && offset + n <= s->rows * TILE_MAP_ROW) {
+    update_shadow(s, bg, offset, &v[3], n);
+    requested_bytes += n * 2;
+    return;
+  }
+  if (s != NULL && offset < s->rows * TILE_MAP_ROW) {
+    // keep the shadow the same as VRAM.
+    update_shadow(s, bg, offset, &v[3], s->rows * TILE_MAP_ROW - offset);
+  }
+
+  // keep the order with the queued commands.
+  snes_ring_flush();
+
+  // U16Array is already in the format of VRAM, so it goes to DMA as it is.
+  if (tiles != NULL && tiles->width == sizeof(u16)) {
+    call_s_cpu(snesw_wait_and_dma_to_vram, sizeof(char *) + sizeof(u16) * 2,
+               tiles->data, (u16)(tile_map_vram_addrs[bg] + offset),
+               (u16)(tiles->size * 2));
+    return;
+  }
 
   static u16 *buf;
   static size_t buf_n;
@@ -50,13 +197,17 @@ static void c_snes_bg_update_tile_map(mrbc_vm *vm, mrbc_value v[], int argc) {
       sa1_free(buf);
     }
 
-    buf = sa1_malloc(sizeof(u16) * n);
-    buf_n = n;
+    buf = bwram_alloc(sizeof(u16) * n);
+    buf_n = buf != NULL ? n : 0;
+    if (buf == NULL) {
+      return;  // ENOMEM
+    }
   }
 
   int i;
   for (i = 0; i < n; i++) {
-    buf[i] = v[3].array->data[i].i;
+    buf[i] = tiles != NULL ? mrbc_packed_array_get(tiles, i)
+                           : v[3].array->data[i].i;
   }
 
   const u16 addr = tile_map_vram_addrs[bg] + offset;
@@ -64,12 +215,91 @@ static void c_snes_bg_update_tile_map(mrbc_vm *vm, mrbc_value v[], int argc) {
              addr, (u16)(n * 2));
 }
 
+// [uploaded bytes, requested bytes] of the tile maps in the last frame.
+static void c_snes_bg_upload_statistics(mrbc_vm *vm, mrbc_value v[],
+                                        int argc) {
+  mrbc_value ret = mrbc_array_new(vm, 2);
+  mrbc_value uploaded = mrbc_integer_value(last_uploaded_bytes);
+  mrbc_value requested = mrbc_integer_value(last_requested_bytes);
+  mrbc_array_push(&ret, &uploaded);
+  mrbc_array_push(&ret, &requested);
+
+  SET_RETURN(ret);
+}
+
+// Uploads the dirty rows of the shadows in a VBlank. Consecutive dirty rows
+// are merged into a span, up to SNES_BG_UPLOAD_MAX bytes in total. Only the
+// rows of the spans are cleared, and the others are left for the next.
+void snes_bg_flush(void) {
+  if (spans == NULL) {
+    spans = bwram_alloc(sizeof(snesw_vram_span) * SNES_BG_UPLOAD_SPANS);
+    if (spans == NULL) {
+      return;
+    }
+  }
+
+  u8 span_bgs[SNES_BG_UPLOAD_SPANS];
+  u16 span_rows[SNES_BG_UPLOAD_SPANS];
+  u16 n = 0;
+  u16 budget = SNES_BG_UPLOAD_MAX;
+  int bg;
+  for (bg = 0; bg < 4; bg++) {
+    tile_map_shadow *s = &shadows[bg];
+    u16 row = 0;
+
+    while (s->tiles != NULL && row < s->rows && n < SNES_BG_UPLOAD_SPANS &&
+           budget >= TILE_MAP_ROW * 2) {
+      if (!(s->dirty[row / 8] & (1 << (row % 8)))) {
+        row++;
+        continue;
+      }
+
+      const u16 start = row;
+      while (row < s->rows && (s->dirty[row / 8] & (1 << (row % 8))) &&
+             budget >= TILE_MAP_ROW * 2) {
+        budget -= TILE_MAP_ROW * 2;
+        row++;
+      }
+
+      spans[n].source = (const u8 *)&s->tiles[start * TILE_MAP_ROW];
+      spans[n].address = tile_map_vram_addrs[bg] + start * TILE_MAP_ROW;
+      spans[n].size = (row - start) * TILE_MAP_ROW * 2;
+      span_bgs[n] = bg;
+      span_rows[n] = start;
+      n++;
+    }
+  }
+
+  if (n > 0) {
+    snes_ring_flush();
+    call_s_cpu(snesw_wait_and_dma_spans_to_vram,
+               sizeof(snesw_vram_span *) + sizeof(u16), spans, n);
+  }
+
+  // clear the rows sent.
+  u16 i;
+  for (i = 0; i < n; i++) {
+    tile_map_shadow *s = &shadows[span_bgs[i]];
+    u16 row = span_rows[i];
+    const u16 end = row + spans[i].size / (TILE_MAP_ROW * 2);
+    for (; row < end; row++) {
+      s->dirty[row / 8] &= ~(1 << (row % 8));
+    }
+  }
+
+  last_requested_bytes = requested_bytes;
+  last_uploaded_bytes = SNES_BG_UPLOAD_MAX - budget;
+  requested_bytes = 0;
+}
+
 void snes_init_class_bg(struct VM *vm, mrbc_class *snes_class) {
   mrbc_class *cls = mrbc_define_class_under(vm, snes_class, "Bg", NULL);
   mrbc_define_method(vm, cls, "scroll", c_snes_bg_scroll);
   mrbc_define_method(vm, cls, "default_tile_maps",
                      c_snes_bg_get_default_tile_map);
   mrbc_define_method(vm, cls, "update_tile_map", c_snes_bg_update_tile_map);
+  mrbc_define_method(vm, cls, "upload_statistics",
+                     c_snes_bg_upload_statistics);
 }
 
 void snes_bg_set_default_tile_map(int bg, const u8 *map, size_t size,
@@ -1,35 +1,121 @@
 #include <snes.h>
+#include <string.h>
 
+#include "sa1/bwram.h"
 #include "sa1/mrubyc/mrubyc.h"
+#include "sa1/ring.h"
+#include "snesw.h"
+
+// Shadow OAM. SA-1 writes the sprites here, and S-CPU copies it to
+// oamMemory once a frame if dirty is set. (see snes_oam_flush)
+static snesw_oam *oam;
+
+// items of a record of SNES::OAM.set_many.
+#define OAM_RECORD_SIZE 7
+
+// Same as oamSet() of pvsneslib. id is the offset in OAM, a multiple of 4.
+static void oam_set(u16 id, u16 x, u16 y, u8 priority, u8 hflip, u8 vflip,
+                    u16 gfxoffset, u8 paletteoffset) {
+  u8 *p = &oam->memory[id & 0x1fc];
+  p[0] = x;
+  p[1] = y;
+  p[2] = gfxoffset;
+  p[3] = (vflip << 7) | (hflip << 6) | ((priority & 3) << 4) |
+         ((paletteoffset & 7) << 1) | ((gfxoffset >> 8) & 1);
+}
+
+// 2 bits of the high table. bit 0 is the 9th bit of x, which hides the
+// sprite out of the screen, and bit 1 is the size.
+static void oam_set_high(u16 id, u8 mask, u8 bits) {
+  const u8 sprite = (id >> 2) & 127;
+  const u8 shift = (sprite & 3) * 2;
+  u8 *p = &oam->memory[128 * 4 + (sprite >> 2)];
+
+  *p = (*p & ~(mask << shift)) | ((bits & mask) << shift);
+}
 
 static void c_snes_oam_set(mrbc_vm *vm, mrbc_value v[], int argc) {
-  call_s_cpu(oamSet,
-             sizeof(u16) * 3 + sizeof(u8) * 3 + sizeof(u16) + sizeof(u8),
-             (u16)v[1].i, (u16)v[2].i, (u16)v[3].i, (u8)v[4].i, (u8)v[5].i,
-             (u8)v[6].i, (u16)v[7].i, (u8)v[8].i);
+  oam_set(v[1].i, v[2].i, v[3].i, v[4].i, v[5].i, v[6].i, v[7].i, v[8].i);
+  oam->dirty = 1;
+}
+
+// SNES::OAM.set_many(id, records)
+// records is a packed array of the arguments of SNES::OAM.set but id,
+// 7 items for each sprite, which are set to id, id + 4, id + 8, ...
+static void c_snes_oam_set_many(mrbc_vm *vm, mrbc_value v[], int argc) {
+  const mrbc_packed_array *records = mrbc_to_packed_array(&v[2]);
+  if (records == NULL) {
+    mrbc_raise(vm, MRBC_CLASS(TypeError), NULL);
+    return;
+  }
+
+  u16 id = v[1].i;
+  int i;
+  for (i = 0; i + OAM_RECORD_SIZE <= records->size; i += OAM_RECORD_SIZE) {
+    oam_set(id, mrbc_packed_array_get(records, i),
+            mrbc_packed_array_get(records, i + 1),
+            mrbc_packed_array_get(records, i + 2),
+            mrbc_packed_array_get(records, i + 3),
+            mrbc_packed_array_get(records, i + 4),
+            mrbc_packed_array_get(records, i + 5),
+            mrbc_packed_array_get(records, i + 6));
+    id += 4;
+  }
+  oam->dirty = 1;
 }
 
 static void c_snes_oam_set_ex(mrbc_vm *vm, mrbc_value v[], int argc) {
   const bool hide = v[3].tt == MRBC_TT_TRUE ? true : false;
 
-  call_s_cpu(oamSetEx, sizeof(u16) + sizeof(u8) * 2, (u16)v[1].i, (u8)v[2].i,
-             (u8)hide);
+  oam_set_high(v[1].i, 3, ((u8)v[2].i << 1) | hide);
+  oam->dirty = 1;
 }
 
 static void c_snes_oam_show(mrbc_vm *vm, mrbc_value v[], int argc) {
-  call_s_cpu(oamSetVisible, sizeof(u16) + sizeof(u8), (u16)v[1].i,
-             (u8)OBJ_SHOW);
+  oam_set_high(v[1].i, 1, OBJ_SHOW);
+  oam->dirty = 1;
 }
 
 static void c_snes_oam_hide(mrbc_vm *vm, mrbc_value v[], int argc) {
-  call_s_cpu(oamSetVisible, sizeof(u16) + sizeof(u8), (u16)v[1].i,
-             (u8)OBJ_HIDE);
+  oam_set_high(v[1].i, 1, OBJ_HIDE);
+  oam->dirty = 1;
+}
+
+int snes_oam_init(void) {
+  oam = bwram_alloc(sizeof(snesw_oam));
+  if (oam == NULL) {
+    return -1;
+  }
+
+  // all sprites are out of the screen, like oamInit() of pvsneslib.
+  int i;
+  memset(oam->memory, 0, sizeof(oam->memory));
+  for (i = 0; i < 128 * 4; i += 4) {
+    oam->memory[i + 1] = 0xe0;
+  }
+  oam->dirty = 1;
+  call_s_cpu(snesw_oam_attach, sizeof(snesw_oam *), oam);
+
+  return 0;
+}
+
+// Queues the copy of the shadow OAM, if it has been changed. pvsneslib
+// uploads oamMemory in every VBlank, so the shadow is not uploaded apart.
+void snes_oam_flush(void) {
+  if (!oam->dirty) {
+    return;
+  }
+
+  snes_ring_reserve(SNESW_COMMAND_OAM_UPDATE);
+  snes_ring_commit();
+  oam->dirty = 0;
 }
 
 void snes_init_class_oam(struct VM *vm, mrbc_class *snes_class) {
   mrbc_class *cls = mrbc_define_class_under(vm, snes_class, "OAM", NULL);
 
   mrbc_define_method(vm, cls, "set", c_snes_oam_set);
+  mrbc_define_method(vm, cls, "set_many", c_snes_oam_set_many);
   mrbc_define_method(vm, cls, "set_ex", c_snes_oam_set_ex);
   mrbc_define_method(vm, cls, "show", c_snes_oam_show);
   mrbc_define_method(vm, cls, "hide", c_snes_oam_hide);
@@ -1,3 +1,5 @@
 #include "sa1/mrubyc/mrubyc.h"
 
+int snes_oam_init(void);
+void snes_oam_flush(void);
 void snes_init_class_oam(struct VM *vm, mrbc_class *snes_class);
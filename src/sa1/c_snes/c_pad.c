@@ -1,10 +1,12 @@
 #include <snes.h>
 
 #include "sa1/mrubyc/mrubyc.h"
+#include "sa1/ring.h"
 #include "snesw.h"
 
 static void c_snes_pad_wait_for_scan(mrbc_vm *vm, mrbc_value v[], int argc) {
-  call_s_cpu(scanPads, 0);
+  snes_ring_reserve(SNESW_COMMAND_SCAN_PADS);
+  snes_ring_commit();
 }
 
 static void c_snes_pad_current(mrbc_vm *vm, mrbc_value v[], int argc) {
@@ -17,6 +19,9 @@ static void c_snes_pad_current(mrbc_vm *vm, mrbc_value v[], int argc) {
   //   return;
   // }
 
+  // the pads have to be scanned by the queued commands first.
+  snes_ring_flush();
+
   u16 res;
   u16 *dst = (void *)((uint32_t)&res + I_RAM_OFFSET);
   call_s_cpu(snesw_pads_current, sizeof(void *) + sizeof(u16), dst,
@@ -1,14 +1,18 @@
 #include <snes.h>
 
 #include "sa1/mrubyc/mrubyc.h"
+#include "sa1/ring.h"
 #include "snesw.h"
 
 static void c_snes_spc_process(mrbc_vm *vm, mrbc_value v[], int argc) {
-  call_s_cpu(spcProcess, 0);
+  snes_ring_reserve(SNESW_COMMAND_SPC_PROCESS);
+  snes_ring_commit();
 }
 
 static void c_snes_spc_play_sound(mrbc_vm *vm, mrbc_value v[], int argc) {
-  call_s_cpu(spcPlaySound, sizeof(u8) * 1, (u8)v[1].i);
+  volatile snesw_command *c = snes_ring_reserve(SNESW_COMMAND_SPC_PLAY_SOUND);
+  c->b[0] = v[1].i;
+  snes_ring_commit();
 }
 
 void snes_init_class_spc(struct VM *vm, mrbc_class *snes_class) {
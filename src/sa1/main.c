@@ -1,13 +1,30 @@
 #include "bg.h"
+#include "bwram.h"
 #include "c_snes.h"
 #include "c_snes/c_bg.h"
+#include "c_snes/c_oam.h"
+#include "ring.h"
+#if defined(MRBC_USE_PRELINK)
+#include "main.rb.prelinked.c"
+#else
 #include "main.rb.bytecode.c"
+#endif
 #include "mrubyc/mrubyc.h"
 
 extern u8 tiles_map, tiles_map_end;
 
 int run() {
+#if !defined(MRBC_ALLOC_LIBC)
+  // memory pool of mruby/c in BW-RAM. (see bwram.h)
+  mrbc_init_alloc((void *)MRBC_MEMORY_POOL_ADDR, MRBC_MEMORY_POOL_SIZE);
+#endif
   mrbc_init_global();
+#if defined(MRBC_USE_PRELINK)
+  // symbol IDs of the pre-linked IREP have to be registered first.
+  if (mrbc_prelink_symbols(&mrbbuf_prelinked) != 0) {
+    return -1;
+  }
+#endif
   mrbc_init_class();
 
   mrbc_vm *vm = mrbc_vm_open(NULL);
@@ -15,13 +32,26 @@ int run() {
     return -1;
   }
 
+  if (snes_ring_init() != 0) {
+    return -1;
+  }
+  if (snes_oam_init() != 0) {
+    return -1;
+  }
+
   snes_init_class_snes(vm);
   snes_bg_set_default_tile_map(1, &tiles_map, (&tiles_map_end - &tiles_map),
                                SNES_BG2_TILE_MAP_VRAM_ADDR);
 
+#if defined(MRBC_USE_PRELINK)
+  if (mrbc_load_prelinked(vm, &mrbbuf_prelinked) != 0) {
+    return -1;
+  }
+#else
   if (mrbc_load_mrb(vm, mrbbuf) != 0) {
     return -1;
   }
+#endif
 
   mrbc_vm_begin(vm);
   int ret = mrbc_vm_run(vm);
@@ -0,0 +1,45 @@
+/* Auto generated by make_symbol_hash.rb */
+#ifndef MRBC_SRC_AUTOGEN_BUILTIN_SYMBOL_HASH_H_
+#define MRBC_SRC_AUTOGEN_BUILTIN_SYMBOL_HASH_H_
+
+#define MRBC_BUILTIN_SYMBOL_HASH_DISP_SIZE 256
+#define MRBC_BUILTIN_SYMBOL_HASH_SIZE 196
+
+#if defined(MRBC_DEFINE_SYMBOL_TABLE)
+static const uint8_t builtin_symbol_hash_disp[] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 8, 0, 0,
+  0, 0, 7, 0, 1, 0, 0, 0, 1, 3, 0, 0, 0, 0, 0, 0,
+  0, 9, 0, 0, 0, 1, 0, 1, 0, 0, 0, 2, 0, 18, 10, 0,
+  8, 0, 0, 2, 0, 9, 0, 0, 0, 5, 0, 0, 2, 17, 4, 1,
+  0, 10, 1, 4, 1, 0, 1, 0, 0, 0, 0, 0, 0, 8, 11, 0,
+  14, 0, 0, 0, 1, 0, 21, 0, 4, 0, 0, 0, 1, 0, 8, 0,
+  0, 0, 0, 12, 8, 0, 4, 4, 0, 0, 0, 6, 0, 12, 9, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 19,
+  0, 9, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 0, 0,
+  19, 0, 0, 0, 10, 34, 0, 0, 40, 0, 0, 2, 5, 35, 0, 0,
+  0, 0, 0, 0, 0, 0, 27, 0, 2, 1, 0, 0, 2, 0, 0, 1,
+  0, 0, 5, 0, 22, 32, 0, 1, 0, 53, 0, 0, 0, 0, 0, 0,
+  0, 40, 3, 2, 14, 0, 4, 5, 8, 0, 36, 36, 0, 0, 0, 1,
+  0, 4, 0, 0, 16, 0, 22, 0, 0, 0, 0, 0, 68, 0, 1, 0,
+  38, 0, 97, 128, 0, 72, 0, 0, 3, 0, 0, 18, 0, 0, 2, 8,
+  82, 0, 0, 0, 20, 84, 4, 0, 0, 0, 0, 141, 0, 0, 6, 0,
+};
+
+static const uint8_t builtin_symbol_hash_id[] = {
+  0, 162, 177, 180, 79, 104, 47, 118, 89, 131, 61, 8, 93, 152, 30, 15,
+  136, 159, 164, 190, 174, 123, 60, 88, 77, 92, 85, 2, 10, 127, 28, 141,
+  128, 36, 98, 52, 3, 191, 4, 167, 1, 7, 5, 169, 192, 170, 168, 11,
+  107, 26, 178, 166, 82, 64, 137, 66, 70, 155, 18, 41, 119, 39, 12, 9,
+  124, 106, 154, 151, 171, 23, 40, 91, 56, 156, 100, 94, 147, 43, 21, 24,
+  116, 173, 176, 134, 126, 105, 58, 157, 163, 53, 50, 175, 31, 27, 86, 103,
+  172, 181, 74, 22, 13, 182, 32, 121, 14, 75, 17, 38, 57, 72, 149, 110,
+  153, 83, 117, 96, 146, 145, 16, 33, 161, 84, 46, 45, 194, 97, 189, 195,
+  34, 125, 158, 143, 71, 179, 76, 19, 140, 20, 193, 114, 102, 68, 142, 188,
+  113, 73, 144, 67, 6, 165, 87, 133, 111, 183, 138, 59, 54, 25, 44, 63,
+  184, 130, 185, 186, 129, 109, 139, 42, 51, 160, 150, 65, 122, 187, 95, 101,
+  112, 120, 108, 132, 69, 99, 55, 135, 78, 49, 148, 48, 35, 80, 37, 115,
+  62, 90, 29, 81,
+};
+#endif
+
+#endif
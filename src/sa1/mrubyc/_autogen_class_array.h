@@ -9,7 +9,9 @@ static const mrbc_sym method_symbols_Array[] = {
   MRBC_SYM(BL_BR),
   MRBC_SYM(BL_BR_EQ),
   MRBC_SYM(at),
+  MRBC_SYM(capacity),
   MRBC_SYM(clear),
+  MRBC_SYM(concat),
   MRBC_SYM(count),
   MRBC_SYM(delete_at),
   MRBC_SYM(dup),
@@ -30,7 +32,9 @@ static const mrbc_sym method_symbols_Array[] = {
   MRBC_SYM(new),
   MRBC_SYM(pop),
   MRBC_SYM(push),
+  MRBC_SYM(reserve),
   MRBC_SYM(shift),
+  MRBC_SYM(shrink_to_fit),
   MRBC_SYM(size),
 #if MRBC_USE_STRING
   MRBC_SYM(to_s),
@@ -46,7 +50,9 @@ static const mrbc_func_t method_functions_Array[] = {
   c_array_get,
   c_array_set,
   c_array_get,
+  c_array_capacity,
   c_array_clear,
+  c_array_concat,
   c_array_size,
   c_array_delete_at,
   c_array_dup,
@@ -67,7 +73,9 @@ static const mrbc_func_t method_functions_Array[] = {
   c_array_new,
   c_array_pop,
   c_array_push,
+  c_array_reserve,
   c_array_shift,
+  c_array_shrink_to_fit,
   c_array_size,
 #if MRBC_USE_STRING
   c_array_inspect,
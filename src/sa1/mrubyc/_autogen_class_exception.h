@@ -144,3 +144,14 @@ struct RClass mrbc_class_ZeroDivisionError = {
   .name = "ZeroDivisionError",
 #endif
 };
+
+/*===== SystemStackError class =====*/
+struct RClass mrbc_class_SystemStackError = {
+  .sym_id = MRBC_SYM(SystemStackError),
+  .num_builtin_method = 0,
+  .super = MRBC_CLASS(Exception),
+  .method_link = 0,
+#if defined(MRBC_DEBUG)
+  .name = "SystemStackError",
+#endif
+};
@@ -0,0 +1,63 @@
+/* Auto generated by make_method_table.rb */
+#include "_autogen_builtin_symbol.h"
+
+/*===== U8Array class =====*/
+static const mrbc_sym method_symbols_U8Array[] = {
+  MRBC_SYM(BL_BR),
+  MRBC_SYM(BL_BR_EQ),
+  MRBC_SYM(bytesize),
+  MRBC_SYM(copy),
+  MRBC_SYM(dup),
+  MRBC_SYM(fill),
+  MRBC_SYM(length),
+  MRBC_SYM(new),
+  MRBC_SYM(size),
+  MRBC_SYM(to_a),
+};
+
+static const mrbc_func_t method_functions_U8Array[] = {
+  c_packed_array_get,
+  c_packed_array_set,
+  c_packed_array_bytesize,
+  c_packed_array_copy,
+  c_packed_array_dup,
+  c_packed_array_fill,
+  c_packed_array_size,
+  c_packed_array_new,
+  c_packed_array_size,
+  c_packed_array_to_a,
+};
+
+struct RBuiltinClass mrbc_class_U8Array = {
+  .sym_id = MRBC_SYM(U8Array),
+  .num_builtin_method = sizeof(method_symbols_U8Array) / sizeof(mrbc_sym),
+  .super = MRBC_CLASS(Object),
+  .method_link = 0,
+#if defined(MRBC_DEBUG)
+  .name = "U8Array",
+#endif
+  .method_symbols = method_symbols_U8Array,
+  .method_functions = method_functions_U8Array,
+};
+
+/*===== U16Array class =====*/
+struct RClass mrbc_class_U16Array = {
+  .sym_id = MRBC_SYM(U16Array),
+  .num_builtin_method = 0,
+  .super = MRBC_CLASS(U8Array),
+  .method_link = 0,
+#if defined(MRBC_DEBUG)
+  .name = "U16Array",
+#endif
+};
+
+/*===== U32Array class =====*/
+struct RClass mrbc_class_U32Array = {
+  .sym_id = MRBC_SYM(U32Array),
+  .num_builtin_method = 0,
+  .super = MRBC_CLASS(U8Array),
+  .method_link = 0,
+#if defined(MRBC_DEBUG)
+  .name = "U32Array",
+#endif
+};
@@ -54,6 +54,9 @@
 /***** Local headers ********************************************************/
 #include "alloc.h"
 #include "hal_selector.h"
+#if defined(MRBC_ALLOC_VMID)
+#include "vm.h"
+#endif
 
 /***** Constant values ******************************************************/
 /*
@@ -221,6 +224,11 @@ typedef struct MEMORY_POOL {
 
 
 /***** Function prototypes **************************************************/
+#if defined(MRBC_USE_SLAB_ALLOC)
+static void slab_cleanup(void);
+static void slab_statistics(struct MRBC_ALLOC_STATISTICS *ret);
+#endif
+
 /***** Local variables ******************************************************/
 // memory pool
 static MEMORY_POOL *memory_pool;
@@ -457,6 +465,13 @@ void mrbc_cleanup_alloc(void)
 #endif
 
   memory_pool = 0;
+#if defined(MRBC_USE_SLAB_ALLOC)
+  slab_cleanup();
+#endif
+#if defined(MRBC_USE_FRAME_ARENA)
+  mrbc_frame_arena_memory = 0;
+  mrbc_frame_arena_memory_end = 0;
+#endif
 }
 
 
@@ -632,6 +647,13 @@ void * mrbc_raw_alloc_no_free(unsigned int size)
 */
 void mrbc_raw_free(void *ptr)
 {
+#if defined(MRBC_USE_FRAME_ARENA)
+  if( MRBC_IN_FRAME_ARENA(ptr) ) {
+    mrbc_frame_arena_free( ptr );
+    return;
+  }
+#endif
+
   MEMORY_POOL *pool = memory_pool;
 
   // get target block
@@ -672,6 +694,10 @@ void mrbc_raw_free(void *ptr)
 */
 void * mrbc_raw_realloc(void *ptr, unsigned int size)
 {
+#if defined(MRBC_USE_FRAME_ARENA)
+  if( MRBC_IN_FRAME_ARENA(ptr) ) return mrbc_frame_arena_realloc( ptr, size );
+#endif
+
   MEMORY_POOL *pool = memory_pool;
   USED_BLOCK *target = (USED_BLOCK *)((uint8_t *)ptr - sizeof(USED_BLOCK));
   MRBC_ALLOC_MEMSIZE_T alloc_size = size + sizeof(USED_BLOCK);
@@ -739,12 +765,16 @@ void * mrbc_raw_realloc(void *ptr, unsigned int size)
 */
 unsigned int mrbc_alloc_usable_size(void *ptr)
 {
+#if defined(MRBC_USE_FRAME_ARENA)
+  if( MRBC_IN_FRAME_ARENA(ptr) ) return mrbc_frame_arena_usable_size( ptr );
+#endif
+
   USED_BLOCK *target = (USED_BLOCK *)((uint8_t *)ptr - sizeof(USED_BLOCK));
   return (unsigned int)(target->size - sizeof(USED_BLOCK));
 }
 
 
-#if defined(MRBC_ALLOC_VMID)
+#if defined(MRBC_ALLOC_VMID) || defined(MRBC_USE_FRAME_ARENA)
 //================================================================
 /*! allocate memory
 
@@ -755,18 +785,29 @@ unsigned int mrbc_alloc_usable_size(void *ptr)
 */
 void * mrbc_alloc(const struct VM *vm, unsigned int size)
 {
+#if defined(MRBC_USE_FRAME_ARENA)
+  void *ptr = mrbc_frame_arena_alloc(vm, size);
+  if( ptr ) return ptr;
+  ptr = mrbc_raw_alloc(size);
+#else
   void *ptr = mrbc_raw_alloc(size);
+#endif
   if( ptr == NULL ) return NULL;	// ENOMEM
 
   if( vm ) mrbc_set_vm_id(ptr, vm->vm_id);
 
   return ptr;
 }
+#endif
 
 
+#if defined(MRBC_ALLOC_VMID)
+
 //================================================================
 /*! release memory, vm used.
 
+  VM ID 0 is shared by the global objects and mrblib, so it is not released.
+
   @param  vm	pointer to VM.
 */
 void mrbc_free_all(const struct VM *vm)
@@ -776,9 +817,14 @@ void mrbc_free_all(const struct VM *vm)
   USED_BLOCK *next;
   int vm_id = vm->vm_id;
 
+  if( vm_id == 0 ) return;
+
   while( target < (USED_BLOCK *)BLOCK_END(pool) ) {
     next = PHYS_NEXT(target);
-    if( IS_FREE_BLOCK(next) ) next = PHYS_NEXT(next);
+    // the sentinel block has no next block.
+    if( next < (USED_BLOCK *)BLOCK_END(pool) && IS_FREE_BLOCK(next) ) {
+      next = PHYS_NEXT(next);
+    }
 
     if( IS_USED_BLOCK(target) && (target->vm_id == vm_id) ) {
       mrbc_raw_free( (uint8_t *)target + sizeof(USED_BLOCK) );
@@ -841,6 +887,10 @@ void mrbc_alloc_statistics( struct MRBC_ALLOC_STATISTICS *ret )
     }
     block = PHYS_NEXT(block);
   }
+
+#if defined(MRBC_USE_SLAB_ALLOC)
+  slab_statistics( ret );
+#endif
 }
 
 
@@ -928,3 +978,449 @@ void mrbc_alloc_print_memory_pool( void )
 
 #endif // defined(MRBC_DEBUG)
 #endif // !defined(MRBC_ALLOC_LIBC)
+
+
+#if defined(MRBC_USE_SLAB_ALLOC)
+/*
+  SLAB ALLOCATOR
+
+  Objects of MRBC_SLAB_MAX_SIZE bytes or smaller are allocated from the
+  free list of its size class. An empty free list is refilled with a chunk
+  of MRBC_SLAB_CHUNK_OBJECTS objects from the memory pool (or sa1_malloc),
+  and the chunks are never returned.
+
+  With MRBC_ALLOC_VMID, each object has a header same as USED_BLOCK,
+  to keep the VM ID.
+*/
+//@cond
+#include "alloc.h"
+#include "vm.h"
+//@endcond
+
+/***** Constant values ******************************************************/
+#if !defined(MRBC_SLAB_CHUNK_OBJECTS)
+#define MRBC_SLAB_CHUNK_OBJECTS 8
+#endif
+
+#if defined(MRBC_ALLOC_VMID)
+#define SLAB_HEADER_SIZE sizeof(USED_BLOCK)
+#else
+#define SLAB_HEADER_SIZE 0
+#endif
+
+/***** Macros ***************************************************************/
+#define SLAB_INDEX(size)	(((size) + MRBC_SLAB_UNIT - 1) / MRBC_SLAB_UNIT - 1)
+
+/***** Typedefs *************************************************************/
+typedef struct SLAB_OBJECT {
+  struct SLAB_OBJECT *next;	//!< next free object of same size class.
+} SLAB_OBJECT;
+
+/***** Local variables ******************************************************/
+static SLAB_OBJECT *slab_free_list[MRBC_SLAB_CLASSES];
+static uint32_t slab_hit[MRBC_SLAB_CLASSES];
+static uint32_t slab_miss[MRBC_SLAB_CLASSES];
+
+
+/***** Local functions ******************************************************/
+//================================================================
+/*! refill the free list of the size class.
+
+  @param  index	index of the size class.
+  @return	zero if no error.
+*/
+static int slab_refill(int index)
+{
+  unsigned int stride = (index + 1) * MRBC_SLAB_UNIT + SLAB_HEADER_SIZE;
+  uint8_t *chunk = mrbc_raw_alloc_no_free( stride * MRBC_SLAB_CHUNK_OBJECTS );
+  if( !chunk ) return -1;	// ENOMEM
+
+  int i;
+  for( i = 0; i < MRBC_SLAB_CHUNK_OBJECTS; i++ ) {
+    SLAB_OBJECT *obj = (SLAB_OBJECT *)(chunk + SLAB_HEADER_SIZE);
+    obj->next = slab_free_list[index];
+    slab_free_list[index] = obj;
+    chunk += stride;
+  }
+
+  return 0;
+}
+
+
+//================================================================
+/*! forget the free lists, when the memory pool is cleaned up.
+*/
+static void slab_cleanup(void)
+{
+  memset( slab_free_list, 0, sizeof(slab_free_list) );
+}
+
+
+//================================================================
+/*! slab counters of the statistics.
+
+  @param  ret		pointer to return value.
+*/
+static void slab_statistics(struct MRBC_ALLOC_STATISTICS *ret)
+{
+  int i;
+  for( i = 0; i < MRBC_SLAB_CLASSES; i++ ) {
+    ret->slab[i].size = (i + 1) * MRBC_SLAB_UNIT;
+    ret->slab[i].hit = slab_hit[i];
+    ret->slab[i].miss = slab_miss[i];
+  }
+}
+
+
+/***** Global functions *****************************************************/
+//================================================================
+/*! allocate fixed size object.
+
+  @param  vm	pointer to VM.
+  @param  size	size of the object.
+  @return void * pointer to allocated memory.
+  @retval NULL	error.
+*/
+void * mrbc_slab_alloc(const struct VM *vm, unsigned int size)
+{
+#if defined(MRBC_USE_FRAME_ARENA)
+  void *ptr = mrbc_frame_arena_alloc(vm, size);
+  if( ptr ) return ptr;
+#endif
+  if( size > MRBC_SLAB_MAX_SIZE ) return mrbc_alloc(vm, size);
+
+  int index = SLAB_INDEX(size);
+  if( slab_free_list[index] ) {
+    slab_hit[index]++;
+  } else {
+    slab_miss[index]++;
+    if( slab_refill(index) != 0 ) return NULL;	// ENOMEM
+  }
+
+  SLAB_OBJECT *obj = slab_free_list[index];
+  slab_free_list[index] = obj->next;
+#if defined(MRBC_ALLOC_VMID)
+  mrbc_set_vm_id( obj, vm ? vm->vm_id : 0 );
+#endif
+
+  return obj;
+}
+
+
+//================================================================
+/*! release fixed size object.
+
+  @param  ptr	Return value of mrbc_slab_alloc()
+  @param  size	size of the object, same as mrbc_slab_alloc()
+*/
+void mrbc_slab_free(void *ptr, unsigned int size)
+{
+  if( size > MRBC_SLAB_MAX_SIZE ) {
+    mrbc_raw_free( ptr );
+    return;
+  }
+#if defined(MRBC_USE_FRAME_ARENA)
+  if( MRBC_IN_FRAME_ARENA(ptr) ) {
+    mrbc_frame_arena_free( ptr );
+    return;
+  }
+#endif
+
+  int index = SLAB_INDEX(size);
+  SLAB_OBJECT *obj = ptr;
+  obj->next = slab_free_list[index];
+  slab_free_list[index] = obj;
+}
+
+
+#if defined(MRBC_ALLOC_LIBC)
+//================================================================
+/*! statistics
+
+  The memory is managed by sa1_malloc, so only the slab counters are returned.
+
+  @param  ret		pointer to return value.
+*/
+void mrbc_alloc_statistics( struct MRBC_ALLOC_STATISTICS *ret )
+{
+  ret->total = 0;
+  ret->used = 0;
+  ret->free = 0;
+  ret->fragmentation = 0;
+  slab_statistics( ret );
+}
+#endif
+#endif // defined(MRBC_USE_SLAB_ALLOC)
+
+
+#if defined(MRBC_USE_FRAME_ARENA)
+/*
+  FRAME ARENA
+
+  The short lived objects of a frame are allocated from the chunks of
+  the frame arena, by bumping the offset of the chunk. At the end of
+  the frame, a chunk without live objects is reset in one step, without
+  releasing each object.
+
+  An object still alive at the end of the frame has escaped from the
+  frame, ex. stored to an instance variable. mruby/c can't find all the
+  references to move the object, so its chunk is promoted instead: the
+  chunk is kept until the all objects in it are released. The free space
+  after the last object of a promoted chunk is still used by the later
+  frames, when no free chunk is left, so an escaped object pins only the
+  space up to its end, not the whole chunk. When the arena is full, the
+  objects are allocated from the heap.
+*/
+//@cond
+#include "alloc.h"
+#include "vm.h"
+//@endcond
+
+/***** Constant values ******************************************************/
+#define FRAME_CHUNK_FREE	0	//!< not used.
+#define FRAME_CHUNK_USED	1	//!< used in the current frame.
+#define FRAME_CHUNK_PROMOTED	2	//!< has live objects of the past frames.
+
+/***** Macros ***************************************************************/
+#define FRAME_CHUNK_TOP(i)	(mrbc_frame_arena_memory + (i) * MRBC_FRAME_ARENA_CHUNK_SIZE)
+
+/***** Typedefs *************************************************************/
+/*
+  The header of each object is the same as the heap, so that
+  mrbc_set_vm_id() works with the object in the arena.
+*/
+#if defined(MRBC_ALLOC_LIBC)
+typedef MRBC_ALLOC_LIBC_HEADER FRAME_HEADER;
+#else
+typedef USED_BLOCK FRAME_HEADER;
+#endif
+
+typedef struct FRAME_CHUNK {
+  uint16_t used;		//!< bump offset.
+  uint16_t live;		//!< n of live objects.
+  uint8_t state;		//!< FRAME_CHUNK_*
+} FRAME_CHUNK;
+
+/***** Global variables *****************************************************/
+uint8_t *mrbc_frame_arena_memory;
+uint8_t *mrbc_frame_arena_memory_end;
+
+/***** Local variables ******************************************************/
+static FRAME_CHUNK frame_chunk[MRBC_FRAME_ARENA_CHUNKS];
+static int frame_current = -1;		//!< chunk of the bump allocation.
+static uint8_t flag_frame_scope;	//!< between begin and end.
+static struct MRBC_FRAME_ARENA_STATISTICS frame_statistics;
+
+
+/***** Local functions ******************************************************/
+//================================================================
+/*! allocate memory from the frame arena.
+
+  @param  size	request size.
+  @return void * pointer to allocated memory.
+  @retval NULL	the arena is full.
+*/
+static void * frame_alloc(unsigned int size)
+{
+  // align pointer size.
+  size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+  unsigned int alloc_size = sizeof(FRAME_HEADER) + size;
+  if( alloc_size > MRBC_FRAME_ARENA_CHUNK_SIZE ) goto OVERFLOW;
+
+  // take a next free chunk, if the current one is full.
+  if( frame_current < 0 ||
+      frame_chunk[frame_current].used + alloc_size > MRBC_FRAME_ARENA_CHUNK_SIZE ) {
+    int i;
+    for( i = 0; i < MRBC_FRAME_ARENA_CHUNKS; i++ ) {
+      if( frame_chunk[i].state == FRAME_CHUNK_FREE ) break;
+    }
+    if( i < MRBC_FRAME_ARENA_CHUNKS ) {
+      frame_statistics.chunks++;
+    } else {
+      // no free chunk. use the rest of a promoted chunk.
+      for( i = 0; i < MRBC_FRAME_ARENA_CHUNKS; i++ ) {
+	if( frame_chunk[i].state == FRAME_CHUNK_PROMOTED &&
+	    frame_chunk[i].used + alloc_size <= MRBC_FRAME_ARENA_CHUNK_SIZE ) break;
+      }
+      if( i == MRBC_FRAME_ARENA_CHUNKS ) goto OVERFLOW;
+    }
+
+    frame_chunk[i].state = FRAME_CHUNK_USED;
+    frame_current = i;
+  }
+
+  FRAME_CHUNK *chunk = &frame_chunk[frame_current];
+  FRAME_HEADER *header = (FRAME_HEADER *)(FRAME_CHUNK_TOP(frame_current) + chunk->used);
+  header->size = size;
+  chunk->used += alloc_size;
+  chunk->live++;
+  frame_statistics.alloc++;
+
+  return header + 1;
+
+ OVERFLOW:
+  frame_statistics.overflow++;
+  return NULL;
+}
+
+
+/***** Global functions *****************************************************/
+//================================================================
+/*! begin the frame scope.
+
+  The memory of the arena is allocated at the first call.
+*/
+void mrbc_frame_arena_begin(void)
+{
+  if( flag_frame_scope ) mrbc_frame_arena_end();
+
+  if( !mrbc_frame_arena_memory ) {
+    unsigned int size = MRBC_FRAME_ARENA_CHUNKS * MRBC_FRAME_ARENA_CHUNK_SIZE;
+    mrbc_frame_arena_memory = mrbc_raw_alloc_no_free( size );
+    if( !mrbc_frame_arena_memory ) return;	// ENOMEM
+    mrbc_frame_arena_memory_end = mrbc_frame_arena_memory + size;
+  }
+
+  flag_frame_scope = 1;
+}
+
+
+//================================================================
+/*! end the frame scope.
+
+  Chunks without live objects are reset, and the others are promoted.
+  A promoted chunk is reset when its last object is released.
+*/
+void mrbc_frame_arena_end(void)
+{
+  int i;
+  for( i = 0; i < MRBC_FRAME_ARENA_CHUNKS; i++ ) {
+    FRAME_CHUNK *chunk = &frame_chunk[i];
+    if( chunk->state != FRAME_CHUNK_USED ) continue;
+
+    if( chunk->live == 0 ) {
+      chunk->state = FRAME_CHUNK_FREE;
+      chunk->used = 0;
+      frame_statistics.chunks--;
+    } else {
+      chunk->state = FRAME_CHUNK_PROMOTED;
+      frame_statistics.promoted++;
+    }
+  }
+
+  frame_current = -1;
+  flag_frame_scope = 0;
+}
+
+
+//================================================================
+/*! allocate memory from the frame arena, in the frame scope.
+
+  @param  vm	pointer to VM.
+  @param  size	request size.
+  @return void * pointer to allocated memory.
+  @retval NULL	not in the frame scope, or the arena is full.
+*/
+void * mrbc_frame_arena_alloc(const struct VM *vm, unsigned int size)
+{
+  if( !flag_frame_scope || !vm ) return NULL;
+
+  void *ptr = frame_alloc( size );
+  if( ptr ) mrbc_set_vm_id( ptr, vm->vm_id );
+
+  return ptr;
+}
+
+
+//================================================================
+/*! release memory in the frame arena.
+
+  @param  ptr	Return value of mrbc_frame_arena_alloc()
+*/
+void mrbc_frame_arena_free(void *ptr)
+{
+  FRAME_HEADER *header = (FRAME_HEADER *)ptr - 1;
+  int i = ((uint8_t *)header - mrbc_frame_arena_memory) / MRBC_FRAME_ARENA_CHUNK_SIZE;
+  FRAME_CHUNK *chunk = &frame_chunk[i];
+
+  // the last object of the current frame can be reused at once.
+  if( chunk->state == FRAME_CHUNK_USED &&
+      (uint8_t *)ptr + header->size == FRAME_CHUNK_TOP(i) + chunk->used ) {
+    chunk->used = (uint8_t *)header - FRAME_CHUNK_TOP(i);
+  }
+
+  if( --chunk->live != 0 ) return;
+
+  // no live objects. the chunk can be reused.
+  chunk->used = 0;
+  if( i != frame_current ) {
+    chunk->state = FRAME_CHUNK_FREE;
+    frame_statistics.chunks--;
+  }
+}
+
+
+//================================================================
+/*! re-allocate memory in the frame arena.
+
+  @param  ptr	Return value of mrbc_frame_arena_alloc()
+  @param  size	request size
+  @return void * pointer to allocated memory.
+  @retval NULL	error.
+*/
+void * mrbc_frame_arena_realloc(void *ptr, unsigned int size)
+{
+  FRAME_HEADER *header = (FRAME_HEADER *)ptr - 1;
+  unsigned int old_size = header->size;
+
+  // shrink in place.
+  if( size <= old_size ) return ptr;
+
+  // expand in place, if it is the last object of the current chunk.
+  int i = ((uint8_t *)header - mrbc_frame_arena_memory) / MRBC_FRAME_ARENA_CHUNK_SIZE;
+  FRAME_CHUNK *chunk = &frame_chunk[i];
+  if( flag_frame_scope && i == frame_current &&
+      (uint8_t *)ptr + old_size == FRAME_CHUNK_TOP(i) + chunk->used ) {
+    size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    if( chunk->used + (size - old_size) <= MRBC_FRAME_ARENA_CHUNK_SIZE ) {
+      chunk->used += size - old_size;
+      header->size = size;
+      return ptr;
+    }
+  }
+
+  // new alloc and copy.
+  void *new_ptr = flag_frame_scope ? frame_alloc( size ) : NULL;
+  if( !new_ptr ) new_ptr = mrbc_raw_alloc( size );
+  if( !new_ptr ) return NULL;	// ENOMEM
+
+  memcpy( new_ptr, ptr, old_size );
+  mrbc_set_vm_id( new_ptr, mrbc_get_vm_id(ptr) );
+  mrbc_frame_arena_free( ptr );
+
+  return new_ptr;
+}
+
+
+//================================================================
+/*! allocated memory size in the frame arena.
+
+  @param  ptr	Return value of mrbc_frame_arena_alloc()
+  @return	usable size.
+*/
+unsigned int mrbc_frame_arena_usable_size(void *ptr)
+{
+  return ((FRAME_HEADER *)ptr - 1)->size;
+}
+
+
+//================================================================
+/*! statistics of the frame arena.
+
+  @param  ret	pointer to return value.
+*/
+void mrbc_frame_arena_statistics(struct MRBC_FRAME_ARENA_STATISTICS *ret)
+{
+  *ret = frame_statistics;
+}
+#endif // defined(MRBC_USE_FRAME_ARENA)
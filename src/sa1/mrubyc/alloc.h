@@ -19,8 +19,10 @@
 /***** Feature test switches ************************************************/
 /***** System headers *******************************************************/
 //@cond
+#include <stdint.h>
 #if defined(MRBC_ALLOC_LIBC)
 #include <stdlib.h>
+#include <string.h>
 #endif
 //@endcond
 
@@ -30,7 +32,35 @@
 extern "C" {
 #endif
 /***** Constant values ******************************************************/
+#if defined(MRBC_USE_SLAB_ALLOC)
+// objects up to MRBC_SLAB_MAX_SIZE bytes are allocated from the slab,
+// in size classes of MRBC_SLAB_UNIT bytes.
+#if !defined(MRBC_SLAB_MAX_SIZE)
+#define MRBC_SLAB_MAX_SIZE 48
+#endif
+#define MRBC_SLAB_UNIT		sizeof(void *)
+#define MRBC_SLAB_CLASSES	(MRBC_SLAB_MAX_SIZE / MRBC_SLAB_UNIT)
+#endif
+
+#if defined(MRBC_USE_FRAME_ARENA)
+// the frame arena is MRBC_FRAME_ARENA_CHUNKS chunks of
+// MRBC_FRAME_ARENA_CHUNK_SIZE bytes.
+#if !defined(MRBC_FRAME_ARENA_CHUNKS)
+#define MRBC_FRAME_ARENA_CHUNKS 8
+#endif
+#if !defined(MRBC_FRAME_ARENA_CHUNK_SIZE)
+#define MRBC_FRAME_ARENA_CHUNK_SIZE 512
+#endif
+#endif
+
 /***** Macros ***************************************************************/
+#if defined(MRBC_USE_FRAME_ARENA)
+//! is the pointer allocated from the frame arena?
+#define MRBC_IN_FRAME_ARENA(ptr) \
+  ((uint8_t *)(ptr) >= mrbc_frame_arena_memory && \
+   (uint8_t *)(ptr) < mrbc_frame_arena_memory_end)
+#endif
+
 /***** Typedefs *************************************************************/
 /*!@brief
   Return value structure for mrbc_alloc_statistics function.
@@ -40,12 +70,48 @@ struct MRBC_ALLOC_STATISTICS {
   unsigned int used;		//!< returns used memory.
   unsigned int free;		//!< returns free memory.
   unsigned int fragmentation;	//!< returns memory fragmentation count.
+#if defined(MRBC_USE_SLAB_ALLOC)
+  struct {
+    uint16_t size;		//!< object size of the class.
+    uint32_t hit;		//!< allocated from the free list.
+    uint32_t miss;		//!< the free list was refilled.
+  } slab[MRBC_SLAB_CLASSES];	//!< returns slab counters of each size class.
+#endif
+};
+
+/*!@brief
+  Return value structure for mrbc_frame_arena_statistics function.
+*/
+struct MRBC_FRAME_ARENA_STATISTICS {
+  uint32_t alloc;		//!< allocated from the frame arena.
+  uint32_t overflow;		//!< allocated from the heap, the arena was full.
+  uint32_t promoted;		//!< chunks kept alive at the end of a frame.
+  uint16_t chunks;		//!< chunks in use now.
 };
 
 struct VM;
 
 /***** Global variables *****************************************************/
+#if defined(MRBC_USE_FRAME_ARENA)
+extern uint8_t *mrbc_frame_arena_memory;
+extern uint8_t *mrbc_frame_arena_memory_end;
+#endif
+
 /***** Function prototypes and inline functions *****************************/
+#if defined(MRBC_USE_FRAME_ARENA)
+/*
+  objects allocated by the VM between mrbc_frame_arena_begin() and
+  mrbc_frame_arena_end() come from the frame arena.
+*/
+void mrbc_frame_arena_begin(void);
+void mrbc_frame_arena_end(void);
+void *mrbc_frame_arena_alloc(const struct VM *vm, unsigned int size);
+void mrbc_frame_arena_free(void *ptr);
+void *mrbc_frame_arena_realloc(void *ptr, unsigned int size);
+unsigned int mrbc_frame_arena_usable_size(void *ptr);
+void mrbc_frame_arena_statistics(struct MRBC_FRAME_ARENA_STATISTICS *ret);
+#endif
+
 #if !defined(MRBC_ALLOC_LIBC)
 /*
   Normally enabled
@@ -71,7 +137,11 @@ void mrbc_set_vm_id(void *ptr, int vm_id);
 int mrbc_get_vm_id(void *ptr);
 
 # else
+#if defined(MRBC_USE_FRAME_ARENA)
+void *mrbc_alloc(const struct VM *vm, unsigned int size);
+#else
 #define mrbc_alloc(vm,size)	mrbc_raw_alloc(size)
+#endif
 #define mrbc_free_all(vm)	((void)0)
 #define mrbc_set_vm_id(ptr,id)	((void)0)
 #define mrbc_get_vm_id(ptr)	0
@@ -86,44 +156,84 @@ int mrbc_get_vm_id(void *ptr);
 #error "Can't use MRBC_ALLOC_LIBC with MRBC_ALLOC_VMID"
 #endif
 
+/*
+  sa1_malloc() does not tell the size of a block, so each block has
+  a header of its usable size. The size is rounded up to
+  MRBC_ALLOC_LIBC_ALIGN, and realloc() grows in place within it.
+  It costs each block the header (4 bytes) and up to 7 bytes of rounding.
+  sa1_malloc() has no interface to grow into the free block next to it,
+  so a block which outgrows its rounding is always moved.
+*/
+#if !defined(MRBC_ALLOC_LIBC_ALIGN)
+#define MRBC_ALLOC_LIBC_ALIGN 8
+#endif
+
+typedef union MRBC_ALLOC_LIBC_HEADER {
+  unsigned int size;	//!< usable size.
+  void *align;		//!< dummy for the alignment of the contents.
+} MRBC_ALLOC_LIBC_HEADER;
+
 static inline void mrbc_init_alloc(void *ptr, unsigned int size) {}
 static inline void mrbc_cleanup_alloc(void) {}
 static inline void *mrbc_raw_alloc(unsigned int size) {
-  return sa1_malloc(size);
+  size = (size + (MRBC_ALLOC_LIBC_ALIGN - 1)) & ~(MRBC_ALLOC_LIBC_ALIGN - 1);
+  MRBC_ALLOC_LIBC_HEADER *header = sa1_malloc(sizeof(MRBC_ALLOC_LIBC_HEADER) + size);
+  if (header == NULL) return NULL;
+
+  header->size = size;
+  return header + 1;
 }
 static inline void *mrbc_raw_alloc_no_free(unsigned int size) {
-  return sa1_malloc(size);
+  return mrbc_raw_alloc(size);
 }
 static inline void mrbc_raw_free(void *ptr) {
-  sa1_free(ptr);
+  if (ptr == NULL) return;
+#if defined(MRBC_USE_FRAME_ARENA)
+  if (MRBC_IN_FRAME_ARENA(ptr)) {
+    mrbc_frame_arena_free(ptr);
+    return;
+  }
+#endif
+  sa1_free((MRBC_ALLOC_LIBC_HEADER *)ptr - 1);
+}
+static inline unsigned int mrbc_alloc_usable_size(void *ptr) {
+#if defined(MRBC_USE_FRAME_ARENA)
+  if (MRBC_IN_FRAME_ARENA(ptr)) return mrbc_frame_arena_usable_size(ptr);
+#endif
+  return ((MRBC_ALLOC_LIBC_HEADER *)ptr - 1)->size;
 }
 static inline void *mrbc_raw_realloc(void *ptr, unsigned int size) {
-  void *new_ptr = sa1_malloc(size);
+#if defined(MRBC_USE_FRAME_ARENA)
+  if (MRBC_IN_FRAME_ARENA(ptr)) return mrbc_frame_arena_realloc(ptr, size);
+#endif
+  if (ptr == NULL) return mrbc_raw_alloc(size);
+
+  unsigned int old_size = mrbc_alloc_usable_size(ptr);
+
+  // fits in the block. shrinking is always done in place, because some
+  // callers don't take the return value when they shrink, same as TLSF.
+  if (size <= old_size) return ptr;
+
+  void *new_ptr = mrbc_raw_alloc(size);
   if (new_ptr == NULL) return NULL;
 
-  memcpy(new_ptr, ptr, size);
-  sa1_free(ptr);
+  memcpy(new_ptr, ptr, old_size);
+  mrbc_raw_free(ptr);
   return new_ptr;
-  // return realloc(ptr, size);
 }
-/*
- * When MRBC_ALLOC_LIBC is defined, you can not use mrbc_alloc_usable_size()
- * as malloc_usable_size() is not defined in C99.
- * If you want to use mrbc_alloc_usable_size(), you need to define like this:
- *
- * unsigned int mrbc_alloc_usable_size(void* ptr) {
- *   return malloc_usable_size(ptr);
- * }
-*/
 static inline void mrbc_free(const struct VM *vm, void *ptr) {
-  sa1_free(ptr);
+  mrbc_raw_free(ptr);
 }
 static inline void * mrbc_realloc(const struct VM *vm, void *ptr, unsigned int size) {
   return mrbc_raw_realloc(ptr, size);
   // return realloc(ptr, size);
 }
 static inline void *mrbc_alloc(const struct VM *vm, unsigned int size) {
-  return sa1_malloc(size);
+#if defined(MRBC_USE_FRAME_ARENA)
+  void *ptr = mrbc_frame_arena_alloc(vm, size);
+  if (ptr != NULL) return ptr;
+#endif
+  return mrbc_raw_alloc(size);
 }
 static inline void mrbc_free_all(const struct VM *vm) {
 }
@@ -132,9 +242,26 @@ static inline void mrbc_set_vm_id(void *ptr, int vm_id) {
 static inline int mrbc_get_vm_id(void *ptr) {
   return 0;
 }
+#if defined(MRBC_USE_SLAB_ALLOC)
+void mrbc_alloc_statistics(struct MRBC_ALLOC_STATISTICS *ret);
+#endif
 #endif	// MRBC_ALLOC_LIBC
 
 
+#if defined(MRBC_USE_SLAB_ALLOC)
+/*
+  fixed size objects are allocated from the slab, with the free lists
+  of each size class. The size has to be passed to mrbc_slab_free().
+*/
+void *mrbc_slab_alloc(const struct VM *vm, unsigned int size);
+void mrbc_slab_free(void *ptr, unsigned int size);
+
+#else
+#define mrbc_slab_alloc(vm,size)	mrbc_alloc(vm,size)
+#define mrbc_slab_free(ptr,size)	mrbc_raw_free(ptr)
+#endif
+
+
 #ifdef __cplusplus
 }
 #endif
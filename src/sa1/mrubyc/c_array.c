@@ -29,6 +29,14 @@
 #include "console.h"
 
 /***** Constat values *******************************************************/
+// the buffer grows by the half of its size, within MIN and MAX items.
+#if !defined(MRBC_ARRAY_GROW_MIN)
+#define MRBC_ARRAY_GROW_MIN 4
+#endif
+#if !defined(MRBC_ARRAY_GROW_MAX)
+#define MRBC_ARRAY_GROW_MAX 64
+#endif
+
 /***** Macros ***************************************************************/
 /***** Typedefs *************************************************************/
 /***** Function prototypes **************************************************/
@@ -36,6 +44,29 @@
 /***** Global variables *****************************************************/
 /***** Signal catching functions ********************************************/
 /***** Local functions ******************************************************/
+//================================================================
+/*! grow buffer to store the size of items, geometrically.
+
+  @param  ary	pointer to target value
+  @param  size	num of items to store
+  @return	mrbc_error_code
+*/
+static int array_grow(mrbc_value *ary, int size)
+{
+  int data_size = ary->array->data_size;
+  if( size <= data_size ) return 0;
+  if( size > MRBC_ARRAY_MAX_SIZE ) return E_NOMEMORY_ERROR;
+
+  int inc = data_size / 2;
+  if( inc < MRBC_ARRAY_GROW_MIN ) inc = MRBC_ARRAY_GROW_MIN;
+  if( inc > MRBC_ARRAY_GROW_MAX ) inc = MRBC_ARRAY_GROW_MAX;
+  if( inc > MRBC_ARRAY_MAX_SIZE - data_size ) inc = MRBC_ARRAY_MAX_SIZE - data_size;
+  if( size < data_size + inc ) size = data_size + inc;
+
+  return mrbc_array_resize(ary, size);
+}
+
+
 /***** Global functions *****************************************************/
 /*
   function summary
@@ -63,6 +94,8 @@
 
  (others)
     mrbc_array_resize
+    mrbc_array_reserve
+    mrbc_array_shrink_to_fit
     mrbc_array_clear
     mrbc_array_compare
     mrbc_array_minmax
@@ -82,16 +115,17 @@
 mrbc_value mrbc_array_new(struct VM *vm, int size)
 {
   mrbc_value value = {.tt = MRBC_TT_ARRAY};
+  if( size > MRBC_ARRAY_MAX_SIZE ) return value;	// ENOMEM
 
   /*
     Allocate handle and data buffer.
   */
-  mrbc_array *h = mrbc_alloc(vm, sizeof(mrbc_array));
+  mrbc_array *h = mrbc_slab_alloc(vm, sizeof(mrbc_array));
   if( !h ) return value;	// ENOMEM
 
   mrbc_value *data = mrbc_alloc(vm, sizeof(mrbc_value) * size);
   if( !data ) {			// ENOMEM
-    mrbc_raw_free( h );
+    mrbc_slab_free( h, sizeof(mrbc_array) );
     return value;
   }
 
@@ -155,6 +189,7 @@ void mrbc_array_clear_vm_id(mrbc_value *ary)
 int mrbc_array_resize(mrbc_value *ary, int size)
 {
   mrbc_array *h = ary->array;
+  if( size > MRBC_ARRAY_MAX_SIZE ) return E_NOMEMORY_ERROR;
 
   mrbc_value *data2 = mrbc_raw_realloc(h->data, sizeof(mrbc_value) * size);
   if( !data2 ) return E_NOMEMORY_ERROR;	// ENOMEM
@@ -166,6 +201,49 @@ int mrbc_array_resize(mrbc_value *ary, int size)
 }
 
 
+//================================================================
+/*! reserve buffer
+
+  @param  ary	pointer to target value
+  @param  size	num of items to store without resize
+  @return	mrbc_error_code
+*/
+int mrbc_array_reserve(mrbc_value *ary, int size)
+{
+  if( size <= ary->array->data_size ) return 0;
+
+  return mrbc_array_resize(ary, size);
+}
+
+
+//================================================================
+/*! release unused buffer
+
+  @param  ary	pointer to target value
+  @return	mrbc_error_code
+*/
+int mrbc_array_shrink_to_fit(mrbc_value *ary)
+{
+  mrbc_array *h = ary->array;
+  if( h->n_stored == h->data_size ) return 0;
+
+#if defined(MRBC_ALLOC_LIBC)
+  // sa1_malloc() can't shrink a block in place, so copy to a new block.
+  mrbc_value *data2 = mrbc_raw_alloc(sizeof(mrbc_value) * h->n_stored);
+  if( !data2 ) return E_NOMEMORY_ERROR;	// ENOMEM
+
+  memcpy( data2, h->data, sizeof(mrbc_value) * h->n_stored );
+  mrbc_raw_free( h->data );
+  h->data = data2;
+  h->data_size = h->n_stored;
+
+  return 0;
+#else
+  return mrbc_array_resize(ary, h->n_stored);
+#endif
+}
+
+
 //================================================================
 /*! setter
 
@@ -184,7 +262,7 @@ int mrbc_array_set(mrbc_value *ary, int idx, mrbc_value *set_val)
   }
 
   // need resize?
-  if( idx >= h->data_size && mrbc_array_resize(ary, idx + 1) != 0 ) {
+  if( array_grow(ary, idx + 1) != 0 ) {
     return E_NOMEMORY_ERROR;			// ENOMEM
   }
 
@@ -236,8 +314,7 @@ int mrbc_array_push(mrbc_value *ary, mrbc_value *set_val)
   mrbc_array *h = ary->array;
 
   if( h->n_stored >= h->data_size ) {
-    int size = h->data_size + 6;
-    if( mrbc_array_resize(ary, size) != 0 ) return E_NOMEMORY_ERROR; // ENOMEM
+    if( array_grow(ary, h->n_stored + 1) != 0 ) return E_NOMEMORY_ERROR; // ENOMEM
   }
 
   h->data[h->n_stored++] = *set_val;
@@ -259,10 +336,7 @@ int mrbc_array_push_m(mrbc_value *ary, mrbc_value *set_val)
   mrbc_array *ha_s = set_val->array;
   int new_size = ha_d->n_stored + ha_s->n_stored;
 
-  if( new_size > ha_d->data_size ) {
-    if( mrbc_array_resize(ary, new_size) != 0 )
-      return E_NOMEMORY_ERROR;		// ENOMEM
-  }
+  if( array_grow(ary, new_size) != 0 ) return E_NOMEMORY_ERROR; // ENOMEM
 
   memcpy( &ha_d->data[ha_d->n_stored], ha_s->data,
 	  sizeof(mrbc_value) * ha_s->n_stored );
@@ -337,13 +411,8 @@ int mrbc_array_insert(mrbc_value *ary, int idx, mrbc_value *set_val)
   }
 
   // need resize?
-  int size = 0;
-  if( idx >= h->data_size ) {
-    size = idx + 1;
-  } else if( h->n_stored >= h->data_size ) {
-    size = h->data_size + 1;
-  }
-  if( size && mrbc_array_resize(ary, size) != 0 ) {
+  int size = (idx >= h->n_stored ? idx : h->n_stored) + 1;
+  if( array_grow(ary, size) != 0 ) {
     return E_NOMEMORY_ERROR;			// ENOMEM
   }
 
@@ -919,6 +988,66 @@ static void c_array_push(struct VM *vm, mrbc_value v[], int argc)
 }
 
 
+//================================================================
+/*! (method) concat
+*/
+static void c_array_concat(struct VM *vm, mrbc_value v[], int argc)
+{
+  if( argc != 1 ) {
+    mrbc_raise( vm, MRBC_CLASS(ArgumentError), 0 );
+    return;
+  }
+  if( mrbc_type(v[1]) != MRBC_TT_ARRAY ) {
+    mrbc_raise( vm, MRBC_CLASS(TypeError), 0 );
+    return;
+  }
+
+  int sz1 = mrbc_array_size(&v[0]);
+  int sz2 = mrbc_array_size(&v[1]);
+  if( mrbc_array_push_m(&v[0], &v[1]) != 0 ) return;	// ENOMEM
+
+  int i;
+  for( i = 0; i < sz2; i++ ) {
+    mrbc_incref( &v[0].array->data[sz1 + i] );
+  }
+}
+
+
+//================================================================
+/*! (method) reserve
+*/
+static void c_array_reserve(struct VM *vm, mrbc_value v[], int argc)
+{
+  if( argc != 1 || mrbc_type(v[1]) != MRBC_TT_INTEGER ||
+      mrbc_integer(v[1]) < 0 || mrbc_integer(v[1]) > MRBC_ARRAY_MAX_SIZE ) {
+    mrbc_raise( vm, MRBC_CLASS(ArgumentError), 0 );
+    return;
+  }
+
+  mrbc_array_reserve(&v[0], mrbc_integer(v[1]));
+}
+
+
+//================================================================
+/*! (method) capacity
+*/
+static void c_array_capacity(struct VM *vm, mrbc_value v[], int argc)
+{
+  int n = v[0].array->data_size;
+
+  SET_INT_RETURN(n);
+}
+
+
+//================================================================
+/*! (method) shrink_to_fit
+*/
+static void c_array_shrink_to_fit(struct VM *vm, mrbc_value v[], int argc)
+{
+  mrbc_array_shrink_to_fit(&v[0]);
+}
+
+
 //================================================================
 /*! (method) pop
 */
@@ -1169,6 +1298,10 @@ static void c_array_join(struct VM *vm, mrbc_value v[], int argc)
   METHOD( "first",	c_array_first )
   METHOD( "last",	c_array_last )
   METHOD( "push",	c_array_push )
+  METHOD( "concat",	c_array_concat )
+  METHOD( "reserve",	c_array_reserve )
+  METHOD( "capacity",	c_array_capacity )
+  METHOD( "shrink_to_fit", c_array_shrink_to_fit )
   METHOD( "pop",	c_array_pop )
   METHOD( "shift",	c_array_shift )
   METHOD( "unshift",	c_array_unshift )
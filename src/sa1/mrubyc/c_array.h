@@ -18,6 +18,7 @@
 /***** System headers *******************************************************/
 //@cond
 #include <stdint.h>
+#include <limits.h>
 //@endcond
 
 /***** Local headers ********************************************************/
@@ -29,6 +30,12 @@ extern "C" {
 #endif
 
 /***** Constat values *******************************************************/
+//! the largest capacity. data_size is 16 bits, and the buffer size in
+//! bytes has to fit in an unsigned int, which is 16 bits on the 65816.
+#define MRBC_ARRAY_MAX_SIZE \
+  ((int)(UINT_MAX / sizeof(mrbc_value) < UINT16_MAX ? \
+	 UINT_MAX / sizeof(mrbc_value) : UINT16_MAX))
+
 /***** Macros ***************************************************************/
 /***** Typedefs *************************************************************/
 //================================================================
@@ -53,6 +60,8 @@ mrbc_value mrbc_array_new(struct VM *vm, int size);
 void mrbc_array_delete(mrbc_value *ary);
 void mrbc_array_clear_vm_id(mrbc_value *ary);
 int mrbc_array_resize(mrbc_value *ary, int size);
+int mrbc_array_reserve(mrbc_value *ary, int size);
+int mrbc_array_shrink_to_fit(mrbc_value *ary);
 int mrbc_array_set(mrbc_value *ary, int idx, mrbc_value *set_val);
 mrbc_value mrbc_array_get(const mrbc_value *ary, int idx);
 int mrbc_array_push(mrbc_value *ary, mrbc_value *set_val);
@@ -87,7 +96,7 @@ static inline void mrbc_array_delete_handle(mrbc_value *ary)
   mrbc_array *h = ary->array;
 
   mrbc_raw_free(h->data);
-  mrbc_raw_free(h);
+  mrbc_slab_free(h, sizeof(mrbc_array));
 }
 
 
@@ -88,12 +88,12 @@ mrbc_value mrbc_hash_new(struct VM *vm, int size)
   /*
     Allocate handle and data buffer.
   */
-  mrbc_hash *h = mrbc_alloc(vm, sizeof(mrbc_hash));
+  mrbc_hash *h = mrbc_slab_alloc(vm, sizeof(mrbc_hash));
   if( !h ) return value;	// ENOMEM
 
   mrbc_value *data = mrbc_alloc(vm, sizeof(mrbc_value) * size * 2);
   if( !data ) {			// ENOMEM
-    mrbc_raw_free( h );
+    mrbc_slab_free( h, sizeof(mrbc_hash) );
     return value;
   }
 
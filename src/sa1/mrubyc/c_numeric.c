@@ -29,6 +29,7 @@
 #include "error.h"
 #include "class.h"
 #include "c_string.h"
+#include "c_numeric.h"
 #include "console.h"
 
 
@@ -149,28 +150,13 @@ static void c_integer_not(struct VM *vm, mrbc_value v[], int argc)
 }
 
 
-//================================================================
-/*! x-bit left shift for x
- */
-static mrbc_int_t shift(mrbc_int_t x, mrbc_int_t y)
-{
-  // Don't support environments that include padding in int.
-  const int INT_BITS = sizeof(mrbc_int_t) * CHAR_BIT;
-
-  if( y >= INT_BITS ) return 0;
-  if( y >= 0 ) return x << y;
-  if( y <= -INT_BITS ) return 0;
-  return x >> -y;
-}
-
-
 //================================================================
 /*! (operator) <<; bit operation LEFT_SHIFT
  */
 static void c_integer_lshift(struct VM *vm, mrbc_value v[], int argc)
 {
   int num = mrbc_integer(v[1]);
-  SET_INT_RETURN( shift(v->i, num) );
+  SET_INT_RETURN( mrbc_integer_shift(v->i, num) );
 }
 
 
@@ -180,7 +166,7 @@ static void c_integer_lshift(struct VM *vm, mrbc_value v[], int argc)
 static void c_integer_rshift(struct VM *vm, mrbc_value v[], int argc)
 {
   int num = mrbc_integer(v[1]);
-  SET_INT_RETURN( shift(v->i, -num) );
+  SET_INT_RETURN( mrbc_integer_shift(v->i, -num) );
 }
 
 
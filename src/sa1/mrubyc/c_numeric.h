@@ -15,11 +15,34 @@
 #ifndef MRBC_SRC_C_NUMERIC_H_
 #define MRBC_SRC_C_NUMERIC_H_
 
+/***** Feature test switches ************************************************/
+/***** System headers *******************************************************/
+//@cond
+#include <limits.h>
+//@endcond
+
+/***** Local headers ********************************************************/
+#include "value.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/***** Inline functions *****************************************************/
+//================================================================
+/*! x-bit left shift for x
+ */
+static inline mrbc_int_t mrbc_integer_shift(mrbc_int_t x, mrbc_int_t y)
+{
+  // Don't support environments that include padding in int.
+  const int INT_BITS = sizeof(mrbc_int_t) * CHAR_BIT;
+
+  if( y >= INT_BITS ) return 0;
+  if( y >= 0 ) return x << y;
+  if( y <= -INT_BITS ) return 0;
+  return x >> -y;
+}
+
 
 #ifdef __cplusplus
 }
@@ -79,6 +79,7 @@ static void c_object_new(struct VM *vm, mrbc_value v[], int argc)
   mrbc_set_nil(&v[argc+1]);
   mrbc_callinfo *callinfo = mrbc_push_callinfo(vm, MRBC_SYM(initialize),
 					       (v - vm->cur_regs), argc);
+  if( !callinfo ) return;
   callinfo->own_class = method.cls;
 
   vm->cur_irep = method.irep;
@@ -161,7 +162,7 @@ static void c_object_dup(struct VM *vm, mrbc_value v[], int argc)
 {
   if( mrbc_type(v[0]) == MRBC_TT_OBJECT ) {
     mrbc_value new_obj = mrbc_instance_new(vm, v->instance->cls, 0);
-    mrbc_kv_dup( &v->instance->ivar, &new_obj.instance->ivar );
+    mrbc_instance_dup_ivar( &new_obj, v );
 
     mrbc_decref( v );
     *v = new_obj;
@@ -385,15 +386,15 @@ static void c_object_instance_variables(struct VM *vm, mrbc_value v[], int argc)
 {
   // temporary code for operation check.
 #if 1
-  mrbc_kv_handle *kvh = &v[0].instance->ivar;
+  const mrbc_instance *ins = v[0].instance;
 
-  mrbc_printf("n = %d/%d ", kvh->n_stored, kvh->data_size);
+  mrbc_printf("n = %d/%d ", ins->shape->n_slots, ins->ivar_size);
   mrbc_printf("[");
 
-  int i;
-  for( i = 0; i < kvh->n_stored; i++ ) {
-    mrbc_printf("%s:@%s", (i == 0 ? "" : ", "),
-		mrbc_symid_to_str( kvh->data[i].sym_id ));
+  const mrbc_shape *shape;
+  for( shape = ins->shape; shape->n_slots != 0; shape = shape->parent ) {
+    mrbc_printf("%s:@%s", (shape == ins->shape ? "" : ", "),
+		mrbc_symid_to_str( shape->sym_id ));
   }
 
   mrbc_printf("]\n");
@@ -482,7 +483,10 @@ static void c_object_attr_reader(struct VM *vm, mrbc_value v[], int argc)
 
     // define reader method
     const char *name = mrbc_symbol_cstr(&v[i]);
-    mrbc_define_method(vm, v[0].cls, name, c_object_getiv);
+    mrbc_method *method = mrbc_define_method(vm, v[0].cls, name, c_object_getiv);
+    if( !method ) return;
+    method->c_func = 3;
+    method->ivar_id = v[i].i;
   }
 }
 
@@ -502,7 +506,10 @@ static void c_object_attr_accessor(struct VM *vm, mrbc_value v[], int argc)
 
     // define reader method
     const char *name = mrbc_symbol_cstr(&v[i]);
-    mrbc_define_method(vm, v[0].cls, name, c_object_getiv);
+    mrbc_method *method = mrbc_define_method(vm, v[0].cls, name, c_object_getiv);
+    if( !method ) return;
+    method->c_func = 3;
+    method->ivar_id = v[i].i;
 
     // make string "....=" and define writer method.
     int len = strlen(name);
@@ -512,8 +519,11 @@ static void c_object_attr_accessor(struct VM *vm, mrbc_value v[], int argc)
     namebuf[len] = '=';
     namebuf[len+1] = 0;
     mrbc_symbol_new(vm, namebuf);
-    mrbc_define_method(vm, v[0].cls, namebuf, c_object_setiv);
+    method = mrbc_define_method(vm, v[0].cls, namebuf, c_object_setiv);
     mrbc_free(vm, namebuf);
+    if( !method ) return;
+    method->c_func = 4;
+    method->ivar_id = v[i].i;
   }
 }
 
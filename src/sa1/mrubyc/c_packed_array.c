@@ -0,0 +1,449 @@
+/*! @file
+  @brief
+  Packed integer arrays. (U8Array, U16Array, U32Array)
+
+  <pre>
+  This file is distributed under BSD 3-Clause License.
+
+  U16Array.new(size, value = 0)
+    [], []=, size, length, bytesize, fill, copy, to_a, dup
+
+  U16Array and U32Array are subclasses of U8Array.
+
+  Items out of the range of the width are truncated.
+  A view of ROM (see mrbc_packed_array_new_rom) is copied to the heap
+  by the first []=, fill or copy.
+  </pre>
+*/
+
+
+/***** Feature test switches ************************************************/
+/***** System headers *******************************************************/
+//@cond
+#include "vm_config.h"
+#include <string.h>
+//@endcond
+
+/***** Local headers ********************************************************/
+#include "alloc.h"
+#include "value.h"
+#include "symbol.h"
+#include "class.h"
+#include "error.h"
+#include "c_array.h"
+#include "c_packed_array.h"
+
+/***** Constat values *******************************************************/
+//! max bytes of the items. (data size of the instance is 16 bit)
+#define MRBC_PACKED_ARRAY_MAX_BYTES	(0xffff - sizeof(mrbc_packed_array))
+
+/***** Macros ***************************************************************/
+/***** Typedefs *************************************************************/
+/***** Function prototypes **************************************************/
+/***** Local variables ******************************************************/
+/***** Global variables *****************************************************/
+/***** Signal catching functions ********************************************/
+/***** Local functions ******************************************************/
+//================================================================
+/*! width of the class, or its super class.
+
+  @param  cls	pointer to class
+  @return	bytes of an item, or 0 if not a packed array class.
+*/
+static int packed_array_width(const mrbc_class *cls)
+{
+  for( ; cls; cls = cls->super ) {
+    if( cls == MRBC_CLASS(U8Array) )  return 1;
+    if( cls == MRBC_CLASS(U16Array) ) return 2;
+    if( cls == MRBC_CLASS(U32Array) ) return 4;
+  }
+  return 0;
+}
+
+
+//================================================================
+/*! fill items
+
+  @param  pa	pointer to packed array
+  @param  start	start index
+  @param  len	num of items
+  @param  val	item
+*/
+static void packed_array_fill(mrbc_packed_array *pa, int start, int len, mrbc_int_t val)
+{
+  if( pa->width == 1 ) {
+    memset( pa->data + start, (uint8_t)val, len );
+    return;
+  }
+
+  int i;
+  for( i = start; i < start + len; i++ ) {
+    mrbc_packed_array_set( pa, i, val );
+  }
+}
+
+
+//================================================================
+/*! get the packed array of the receiver.
+
+  @param  vm	pointer to VM.
+  @param  v	pointer to the receiver
+  @return	pointer to packed array, or NULL if raised TypeError.
+*/
+static mrbc_packed_array * packed_array_self(struct VM *vm, mrbc_value *v)
+{
+  mrbc_packed_array *pa = mrbc_to_packed_array(v);
+  if( !pa ) mrbc_raise( vm, MRBC_CLASS(TypeError), "not a packed array" );
+
+  return pa;
+}
+
+
+/***** Global functions *****************************************************/
+//================================================================
+/*! constructor
+
+  @param  vm	pointer to VM.
+  @param  cls	U8Array, U16Array, U32Array or its sub class.
+  @param  size	num of items
+  @return	packed array object, filled with zero.
+*/
+mrbc_value mrbc_packed_array_new(struct VM *vm, mrbc_class *cls, int size)
+{
+  int width = packed_array_width(cls);
+  mrbc_value value = mrbc_instance_new(vm, cls, sizeof(mrbc_packed_array) + width * size);
+  if( value.instance == NULL ) return value;	// ENOMEM
+
+  mrbc_packed_array *pa = (mrbc_packed_array *)value.instance->data;
+  pa->size = size;
+  pa->width = width;
+  pa->flags = 0;
+  pa->data = pa->buf;
+  memset( pa->data, 0, width * size );
+
+  return value;
+}
+
+
+//================================================================
+/*! constructor of the read only view of ROM.
+
+  The items are not copied until the first write.
+
+  @param  vm	pointer to VM.
+  @param  cls	U8Array, U16Array, U32Array or its sub class.
+  @param  rom	pointer to the items in ROM.
+  @param  size	num of items
+  @return	packed array object.
+*/
+mrbc_value mrbc_packed_array_new_rom(struct VM *vm, mrbc_class *cls, const void *rom, int size)
+{
+  mrbc_value value = mrbc_instance_new(vm, cls, sizeof(mrbc_packed_array));
+  if( value.instance == NULL ) return value;	// ENOMEM
+
+  mrbc_packed_array *pa = (mrbc_packed_array *)value.instance->data;
+  pa->size = size;
+  pa->width = packed_array_width(cls);
+  pa->flags = MRBC_PACKED_ARRAY_ROM;
+  pa->data = (uint8_t *)rom;
+
+  return value;
+}
+
+
+//================================================================
+/*! copy the items of ROM view to the heap.
+
+  @param  pa	pointer to packed array
+  @return	0 if success, or -1 if ENOMEM.
+*/
+int mrbc_packed_array_unshare(mrbc_packed_array *pa)
+{
+  unsigned int bytes = pa->size * pa->width;
+  uint8_t *data = mrbc_raw_alloc( bytes ? bytes : 1 );
+  if( !data ) return -1;	// ENOMEM
+
+  memcpy( data, pa->data, bytes );
+  pa->data = data;
+  pa->flags = MRBC_PACKED_ARRAY_HEAP;
+
+  return 0;
+}
+
+
+//================================================================
+/*! release the items allocated apart from the instance.
+
+  @param  pa	pointer to packed array
+*/
+void mrbc_packed_array_delete(mrbc_packed_array *pa)
+{
+  if( pa->flags & MRBC_PACKED_ARRAY_HEAP ) mrbc_raw_free( pa->data );
+}
+
+
+//================================================================
+/*! (method) new
+*/
+static void c_packed_array_new(struct VM *vm, mrbc_value v[], int argc)
+{
+  if( mrbc_type(v[0]) != MRBC_TT_CLASS ) {
+    mrbc_raise( vm, MRBC_CLASS(NoMethodError), "undefined method 'new'" );
+    return;
+  }
+
+  int width = packed_array_width(v[0].cls);
+  if( argc < 1 || argc > 2 || mrbc_type(v[1]) != MRBC_TT_INTEGER ||
+      (argc == 2 && mrbc_type(v[2]) != MRBC_TT_INTEGER) ) goto ARGUMENT_ERROR;
+
+  int size = mrbc_integer(v[1]);
+  if( size < 0 || size > MRBC_PACKED_ARRAY_MAX_BYTES / width ) goto ARGUMENT_ERROR;
+
+  mrbc_value ret = mrbc_packed_array_new(vm, v[0].cls, size);
+  if( ret.instance == NULL ) return;		// ENOMEM
+
+  if( argc == 2 && mrbc_integer(v[2]) != 0 ) {
+    packed_array_fill( (mrbc_packed_array *)ret.instance->data, 0, size,
+		       mrbc_integer(v[2]) );
+  }
+  SET_RETURN(ret);
+  return;
+
+ ARGUMENT_ERROR:
+  mrbc_raise( vm, MRBC_CLASS(ArgumentError), 0 );
+}
+
+
+//================================================================
+/*! (operator) []
+*/
+static void c_packed_array_get(struct VM *vm, mrbc_value v[], int argc)
+{
+  if( argc != 1 || mrbc_type(v[1]) != MRBC_TT_INTEGER ) {
+    mrbc_raise( vm, MRBC_CLASS(ArgumentError), 0 );
+    return;
+  }
+
+  mrbc_packed_array *pa = packed_array_self(vm, &v[0]);
+  if( !pa ) return;
+  int idx = mrbc_integer(v[1]);
+  if( idx < 0 ) idx += pa->size;
+  if( idx < 0 || idx >= pa->size ) {
+    SET_NIL_RETURN();
+    return;
+  }
+
+  SET_INT_RETURN( mrbc_packed_array_get(pa, idx) );
+}
+
+
+//================================================================
+/*! (operator) []=
+*/
+static void c_packed_array_set(struct VM *vm, mrbc_value v[], int argc)
+{
+  if( argc != 2 || mrbc_type(v[1]) != MRBC_TT_INTEGER ||
+      mrbc_type(v[2]) != MRBC_TT_INTEGER ) {
+    mrbc_raise( vm, MRBC_CLASS(ArgumentError), 0 );
+    return;
+  }
+
+  mrbc_packed_array *pa = packed_array_self(vm, &v[0]);
+  if( !pa ) return;
+  int idx = mrbc_integer(v[1]);
+  if( idx < 0 ) idx += pa->size;
+  if( idx < 0 || idx >= pa->size ) {
+    mrbc_raise( vm, MRBC_CLASS(IndexError), "index out of range" );
+    return;
+  }
+  if( mrbc_packed_array_writable(pa) != 0 ) return;	// ENOMEM
+
+  mrbc_packed_array_set( pa, idx, mrbc_integer(v[2]) );
+  SET_RETURN( v[2] );
+}
+
+
+//================================================================
+/*! (method) size
+*/
+static void c_packed_array_size(struct VM *vm, mrbc_value v[], int argc)
+{
+  mrbc_packed_array *pa = packed_array_self(vm, &v[0]);
+  if( !pa ) return;
+
+  SET_INT_RETURN( pa->size );
+}
+
+
+//================================================================
+/*! (method) bytesize
+*/
+static void c_packed_array_bytesize(struct VM *vm, mrbc_value v[], int argc)
+{
+  mrbc_packed_array *pa = packed_array_self(vm, &v[0]);
+  if( !pa ) return;
+
+  SET_INT_RETURN( pa->size * pa->width );
+}
+
+
+//================================================================
+/*! (method) fill(value, start = 0, length = size - start)
+*/
+static void c_packed_array_fill(struct VM *vm, mrbc_value v[], int argc)
+{
+  mrbc_packed_array *pa = packed_array_self(vm, &v[0]);
+  if( !pa ) return;
+  int start = 0;
+  int len = pa->size;
+
+  if( argc < 1 || argc > 3 ) goto ARGUMENT_ERROR;
+  int i;
+  for( i = 1; i <= argc; i++ ) {
+    if( mrbc_type(v[i]) != MRBC_TT_INTEGER ) goto ARGUMENT_ERROR;
+  }
+
+  if( argc >= 2 ) {
+    start = mrbc_integer(v[2]);
+    if( start < 0 ) start += pa->size;
+    if( start < 0 ) start = 0;
+    len = pa->size - start;
+  }
+  if( argc >= 3 && mrbc_integer(v[3]) < len ) len = mrbc_integer(v[3]);
+  if( len <= 0 ) return;
+  if( mrbc_packed_array_writable(pa) != 0 ) return;	// ENOMEM
+
+  packed_array_fill( pa, start, len, mrbc_integer(v[1]) );
+  return;
+
+ ARGUMENT_ERROR:
+  mrbc_raise( vm, MRBC_CLASS(ArgumentError), 0 );
+}
+
+
+//================================================================
+/*! (method) copy(src, pos = 0)
+
+  Copy the items of src (packed array or Array of Integer) to pos.
+  Items over the end are ignored.
+*/
+static void c_packed_array_copy(struct VM *vm, mrbc_value v[], int argc)
+{
+  mrbc_packed_array *pa = packed_array_self(vm, &v[0]);
+  if( !pa ) return;
+  int pos = 0;
+
+  if( argc < 1 || argc > 2 ) goto ARGUMENT_ERROR;
+  if( argc == 2 ) {
+    if( mrbc_type(v[2]) != MRBC_TT_INTEGER ) goto ARGUMENT_ERROR;
+    pos = mrbc_integer(v[2]);
+    if( pos < 0 ) pos += pa->size;
+    if( pos < 0 ) goto ARGUMENT_ERROR;
+  }
+  if( pos >= pa->size ) return;
+
+  int i;
+  const mrbc_packed_array *src = 0;
+  if( mrbc_type(v[1]) != MRBC_TT_ARRAY ) {
+    src = mrbc_to_packed_array(&v[1]);
+    if( !src ) goto ARGUMENT_ERROR;
+  }
+
+  int len = src ? src->size : mrbc_array_size(&v[1]);
+  if( len > pa->size - pos ) len = pa->size - pos;
+  if( mrbc_packed_array_writable(pa) != 0 ) return;	// ENOMEM
+
+  if( src && src->width == pa->width ) {
+    memmove( pa->data + pos * pa->width, src->data, len * pa->width );
+
+  } else if( src ) {
+    for( i = 0; i < len; i++ ) {
+      mrbc_packed_array_set( pa, pos + i, mrbc_packed_array_get(src, i) );
+    }
+
+  } else {
+    const mrbc_value *data = v[1].array->data;
+    for( i = 0; i < len; i++ ) {
+      if( mrbc_type(data[i]) != MRBC_TT_INTEGER ) {
+	mrbc_raise( vm, MRBC_CLASS(TypeError), 0 );
+	return;
+      }
+      mrbc_packed_array_set( pa, pos + i, mrbc_integer(data[i]) );
+    }
+  }
+  return;
+
+ ARGUMENT_ERROR:
+  mrbc_raise( vm, MRBC_CLASS(ArgumentError), 0 );
+}
+
+
+//================================================================
+/*! (method) to_a
+*/
+static void c_packed_array_to_a(struct VM *vm, mrbc_value v[], int argc)
+{
+  mrbc_packed_array *pa = packed_array_self(vm, &v[0]);
+  if( !pa ) return;
+  mrbc_value ret = mrbc_array_new(vm, pa->size);
+  if( ret.array == NULL ) return;		// ENOMEM
+
+  int i;
+  for( i = 0; i < pa->size; i++ ) {
+    ret.array->data[i] = mrbc_integer_value( mrbc_packed_array_get(pa, i) );
+  }
+  ret.array->n_stored = pa->size;
+
+  SET_RETURN(ret);
+}
+
+
+//================================================================
+/*! (method) dup
+
+  A view of ROM is duplicated as a view of the same ROM.
+*/
+static void c_packed_array_dup(struct VM *vm, mrbc_value v[], int argc)
+{
+  mrbc_packed_array *pa = packed_array_self(vm, &v[0]);
+  if( !pa ) return;
+
+  mrbc_class *cls = v[0].instance->cls;
+  mrbc_value ret;
+  if( pa->flags & MRBC_PACKED_ARRAY_ROM ) {
+    ret = mrbc_packed_array_new_rom(vm, cls, pa->data, pa->size);
+    if( ret.instance == NULL ) return;		// ENOMEM
+  } else {
+    ret = mrbc_packed_array_new(vm, cls, pa->size);
+    if( ret.instance == NULL ) return;		// ENOMEM
+    memcpy( ((mrbc_packed_array *)ret.instance->data)->data, pa->data,
+	    pa->size * pa->width );
+  }
+  mrbc_instance_dup_ivar( &ret, &v[0] );
+
+  SET_RETURN(ret);
+}
+
+
+/* MRBC_AUTOGEN_METHOD_TABLE
+  FILE("_autogen_class_packed_array.h")
+
+  CLASS("U8Array")
+  METHOD("new",		c_packed_array_new )
+  METHOD("[]",		c_packed_array_get )
+  METHOD("[]=",		c_packed_array_set )
+  METHOD("size",	c_packed_array_size )
+  METHOD("length",	c_packed_array_size )
+  METHOD("bytesize",	c_packed_array_bytesize )
+  METHOD("fill",	c_packed_array_fill )
+  METHOD("copy",	c_packed_array_copy )
+  METHOD("to_a",	c_packed_array_to_a )
+  METHOD("dup",		c_packed_array_dup )
+
+  CLASS("U16Array")
+  SUPER("U8Array")
+
+  CLASS("U32Array")
+  SUPER("U8Array")
+*/
+#include "_autogen_class_packed_array.h"
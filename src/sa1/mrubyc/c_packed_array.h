@@ -0,0 +1,148 @@
+/*! @file
+  @brief
+  Packed integer arrays. (U8Array, U16Array, U32Array)
+
+  <pre>
+  This file is distributed under BSD 3-Clause License.
+
+  Items are stored in 1, 2 or 4 bytes without mrbc_value, so the buffer
+  can be handed over to DMA as it is.
+  A packed array can also be a view of data in ROM. It is copied to the
+  heap on the first write. (copy on write)
+  </pre>
+*/
+
+#ifndef MRBC_SRC_C_PACKED_ARRAY_H_
+#define MRBC_SRC_C_PACKED_ARRAY_H_
+
+/***** Feature test switches ************************************************/
+/***** System headers *******************************************************/
+//@cond
+#include <stdint.h>
+//@endcond
+
+/***** Local headers ********************************************************/
+#include "value.h"
+#include "alloc.h"
+#include "class.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***** Constat values *******************************************************/
+//! flags of the packed array.
+#define MRBC_PACKED_ARRAY_ROM	0x01	//!< data points to ROM. read only.
+#define MRBC_PACKED_ARRAY_HEAP	0x02	//!< data is allocated apart from the instance.
+
+/***** Macros ***************************************************************/
+/***** Typedefs *************************************************************/
+//================================================================
+/*!@brief
+  Packed array, placed in data[] of the instance.
+*/
+typedef struct RPackedArray {
+  uint16_t size;	//!< num of items.
+  uint8_t width;	//!< bytes of an item. 1, 2 or 4.
+  uint8_t flags;	//!< MRBC_PACKED_ARRAY_ROM or MRBC_PACKED_ARRAY_HEAP.
+  uint8_t *data;	//!< items. points to buf[], ROM or heap.
+  uint8_t buf[];	//!< items, if placed in the instance.
+
+} mrbc_packed_array;
+
+
+/***** Global variables *****************************************************/
+extern struct RBuiltinClass mrbc_class_U8Array;
+extern struct RClass mrbc_class_U16Array;
+extern struct RClass mrbc_class_U32Array;
+
+
+/***** Function prototypes **************************************************/
+mrbc_value mrbc_packed_array_new(struct VM *vm, mrbc_class *cls, int size);
+mrbc_value mrbc_packed_array_new_rom(struct VM *vm, mrbc_class *cls, const void *rom, int size);
+int mrbc_packed_array_unshare(mrbc_packed_array *pa);
+void mrbc_packed_array_delete(mrbc_packed_array *pa);
+
+
+/***** Inline functions *****************************************************/
+//================================================================
+/*! get the packed array of U8Array, U16Array and U32Array object.
+
+  @param  v	pointer to target value
+  @return	pointer to packed array, or NULL if not.
+*/
+static inline mrbc_packed_array * mrbc_to_packed_array(const mrbc_value *v)
+{
+  if( v->tt != MRBC_TT_OBJECT ) return 0;
+
+  // U16Array and U32Array are subclasses of U8Array.
+  const mrbc_class *cls = v->instance->cls;
+  while( cls != MRBC_CLASS(U8Array) ) {
+    cls = cls->super;
+    if( !cls ) return 0;
+  }
+
+  // an instance not made by the constructors has no room for it.
+#if defined(MRBC_USE_SLAB_ALLOC)
+  if( v->instance->data_size < sizeof(mrbc_packed_array) ) return 0;
+#else
+  if( mrbc_alloc_usable_size(v->instance) <
+      sizeof(mrbc_instance) + sizeof(mrbc_packed_array) ) return 0;
+#endif
+
+  return (mrbc_packed_array *)v->instance->data;
+}
+
+
+//================================================================
+/*! make the items writable, copying them out of ROM if needed.
+
+  @param  pa	pointer to packed array
+  @return	0 if success, or -1 if ENOMEM.
+*/
+static inline int mrbc_packed_array_writable(mrbc_packed_array *pa)
+{
+  if( !(pa->flags & MRBC_PACKED_ARRAY_ROM) ) return 0;
+  return mrbc_packed_array_unshare(pa);
+}
+
+
+//================================================================
+/*! getter
+
+  @param  pa	pointer to packed array
+  @param  idx	index, 0 <= idx < size
+  @return	item
+*/
+static inline mrbc_int_t mrbc_packed_array_get(const mrbc_packed_array *pa, int idx)
+{
+  switch( pa->width ) {
+  case 1:  return pa->data[idx];
+  case 2:  return ((const uint16_t *)pa->data)[idx];
+  default: return ((const uint32_t *)pa->data)[idx];
+  }
+}
+
+
+//================================================================
+/*! setter
+
+  @param  pa	pointer to packed array
+  @param  idx	index, 0 <= idx < size
+  @param  val	item, truncated to the width
+  @note	the items must be writable. see mrbc_packed_array_writable()
+*/
+static inline void mrbc_packed_array_set(mrbc_packed_array *pa, int idx, mrbc_int_t val)
+{
+  switch( pa->width ) {
+  case 1:  pa->data[idx] = val; break;
+  case 2:  ((uint16_t *)pa->data)[idx] = val; break;
+  default: ((uint32_t *)pa->data)[idx] = val; break;
+  }
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -50,7 +50,7 @@ mrbc_value mrbc_range_new(struct VM *vm, mrbc_value *first, mrbc_value *last, in
 {
   mrbc_value value = {.tt = MRBC_TT_RANGE};
 
-  value.range = mrbc_alloc(vm, sizeof(mrbc_range));
+  value.range = mrbc_slab_alloc(vm, sizeof(mrbc_range));
   if( !value.range ) return value;		// ENOMEM
 
   MRBC_INIT_OBJECT_HEADER( value.range, "RA" );
@@ -72,7 +72,7 @@ void mrbc_range_delete(mrbc_value *v)
   mrbc_decref( &v->range->first );
   mrbc_decref( &v->range->last );
 
-  mrbc_raw_free( v->range );
+  mrbc_slab_free( v->range, sizeof(mrbc_range) );
 }
 
 
@@ -75,12 +75,12 @@ mrbc_value mrbc_string_new(struct VM *vm, const void *src, int len)
   /*
     Allocate handle and string buffer.
   */
-  mrbc_string *h = mrbc_alloc(vm, sizeof(mrbc_string));
+  mrbc_string *h = mrbc_slab_alloc(vm, sizeof(mrbc_string));
   if( !h ) return value;		// ENOMEM
 
   uint8_t *str = mrbc_alloc(vm, len+1);
   if( !str ) {				// ENOMEM
-    mrbc_raw_free( h );
+    mrbc_slab_free( h, sizeof(mrbc_string) );
     return value;
   }
 
@@ -131,7 +131,7 @@ mrbc_value mrbc_string_new_alloc(struct VM *vm, void *buf, int len)
   /*
     Allocate handle
   */
-  mrbc_string *h = mrbc_alloc(vm, sizeof(mrbc_string));
+  mrbc_string *h = mrbc_slab_alloc(vm, sizeof(mrbc_string));
   if( !h ) return value;		// ENOMEM
 
   MRBC_INIT_OBJECT_HEADER( h, "ST" );
@@ -151,7 +151,7 @@ mrbc_value mrbc_string_new_alloc(struct VM *vm, void *buf, int len)
 void mrbc_string_delete(mrbc_value *str)
 {
   mrbc_raw_free(str->string->data);
-  mrbc_raw_free(str->string);
+  mrbc_slab_free(str->string, sizeof(mrbc_string));
 }
 
 
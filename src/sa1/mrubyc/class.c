@@ -30,6 +30,7 @@
 #include "c_string.h"
 #include "c_array.h"
 #include "c_hash.h"
+#include "c_packed_array.h"
 #include "global.h"
 #include "vm.h"
 #include "load.h"
@@ -41,6 +42,10 @@
 /***** Typedefs *************************************************************/
 /***** Function prototypes **************************************************/
 /***** Local variables ******************************************************/
+//! root of the shape tree. (no instance variables)
+static mrbc_shape shape_root;
+
+
 /***** Global variables *****************************************************/
 /*! Builtin class table.
 
@@ -69,9 +74,47 @@ mrbc_class * const mrbc_class_tbl[MRBC_TT_MAXVAL+1] = {
   0,				// MRBC_TT_EXCEPTION = 14,
 };
 
+//! Generation of inline method caches. (1-0x7fff, see vm.h)
+uint16_t mrbc_method_cache_generation = 1;
+
 
 /***** Signal catching functions ********************************************/
 /***** Local functions ******************************************************/
+//================================================================
+/*! get the shape that an instance variable added.
+
+  @param  shape		pointer to the current shape.
+  @param  sym_id	symbol ID of the additional ivar.
+  @return		pointer to the next shape or NULL.
+*/
+static mrbc_shape * shape_transition(mrbc_shape *shape, mrbc_sym sym_id)
+{
+  mrbc_shape *child;
+  for( child = shape->child; child != 0; child = child->sibling ) {
+    if( child->sym_id == sym_id ) return child;
+  }
+
+  if( shape->n_slots == UINT8_MAX ) return 0;
+  child = mrbc_raw_alloc_no_free( sizeof(mrbc_shape) );
+  if( !child ) return 0;	// ENOMEM
+
+  child->parent = shape;
+  child->child = 0;
+  child->sibling = shape->child;
+  child->sym_id = sym_id;
+  child->n_slots = shape->n_slots + 1;
+  child->max_slots = child->n_slots;
+  shape->child = child;
+
+  // update the capacity hint of ancestors.
+  for( ; shape && shape->max_slots < child->n_slots; shape = shape->parent ) {
+    shape->max_slots = child->n_slots;
+  }
+
+  return child;
+}
+
+
 /***** Global functions *****************************************************/
 //================================================================
 /*! define class
@@ -175,13 +218,14 @@ mrbc_class * mrbc_define_class_under(struct VM *vm, const mrbc_class *outer, con
   @param  cls		pointer to class.
   @param  name		method name.
   @param  cfunc		pointer to function.
+  @return		pointer to defined method or NULL.
 */
-void mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_func_t cfunc)
+mrbc_method *mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_func_t cfunc)
 {
   if( cls == NULL ) cls = mrbc_class_object;	// set default to Object.
 
   mrbc_method *method = mrbc_raw_alloc_no_free( sizeof(mrbc_method) );
-  if( !method ) return; // ENOMEM
+  if( !method ) return NULL; // ENOMEM
 
   method->type = 'm';
   method->c_func = 1;
@@ -195,6 +239,9 @@ void mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_f
   method->func = cfunc;
   method->next = cls->method_link;
   cls->method_link = method;
+
+  mrbc_clear_method_cache();
+  return method;
 }
 
 
@@ -209,17 +256,17 @@ void mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_f
 mrbc_value mrbc_instance_new(struct VM *vm, mrbc_class *cls, int size)
 {
   mrbc_value v = {.tt = MRBC_TT_OBJECT};
-  v.instance = mrbc_alloc(vm, sizeof(mrbc_instance) + size);
+  v.instance = mrbc_slab_alloc(vm, sizeof(mrbc_instance) + size);
   if( v.instance == NULL ) return v;	// ENOMEM
 
-  if( mrbc_kv_init_handle(vm, &v.instance->ivar, 0) != 0 ) {
-    mrbc_raw_free(v.instance);
-    v.instance = NULL;
-    return v;
-  }
-
   MRBC_INIT_OBJECT_HEADER( v.instance, "IN" );
+#if defined(MRBC_USE_SLAB_ALLOC)
+  v.instance->data_size = size;
+#endif
   v.instance->cls = cls;
+  v.instance->shape = &shape_root;
+  v.instance->ivar_size = 0;
+  v.instance->ivar = 0;
 
   return v;
 }
@@ -232,8 +279,22 @@ mrbc_value mrbc_instance_new(struct VM *vm, mrbc_class *cls, int size)
 */
 void mrbc_instance_delete(mrbc_value *v)
 {
-  mrbc_kv_delete_data( &v->instance->ivar );
-  mrbc_raw_free( v->instance );
+  mrbc_instance *ins = v->instance;
+  int i;
+  for( i = 0; i < ins->shape->n_slots; i++ ) {
+    mrbc_decref( &ins->ivar[i] );
+  }
+
+  if( ins->ivar ) mrbc_raw_free( ins->ivar );
+
+  mrbc_packed_array *pa = mrbc_to_packed_array(v);
+  if( pa ) mrbc_packed_array_delete( pa );
+
+#if defined(MRBC_USE_SLAB_ALLOC)
+  mrbc_slab_free( ins, sizeof(mrbc_instance) + ins->data_size );
+#else
+  mrbc_raw_free( ins );
+#endif
 }
 
 
@@ -246,8 +307,41 @@ void mrbc_instance_delete(mrbc_value *v)
 */
 void mrbc_instance_setiv(mrbc_value *obj, mrbc_sym sym_id, mrbc_value *v)
 {
+  mrbc_instance *ins = obj->instance;
+  int slot = mrbc_shape_find_slot( ins->shape, sym_id );
+
+  // replace value ?
+  if( slot >= 0 ) {
+    mrbc_incref(v);
+    mrbc_decref( &ins->ivar[slot] );
+    ins->ivar[slot] = *v;
+    return;
+  }
+
+  // add new instance variable.
+  mrbc_shape *shape = shape_transition( ins->shape, sym_id );
+  if( !shape ) return;	// ENOMEM
+
+  slot = shape->n_slots - 1;
+  if( slot >= ins->ivar_size ) {
+    // allocate slots as many as the other instances of this shape have.
+    int size = shape->max_slots;
+    mrbc_value *ivar;
+    if( ins->ivar ) {
+      ivar = mrbc_raw_realloc( ins->ivar, sizeof(mrbc_value) * size );
+    } else {
+      ivar = mrbc_raw_alloc( sizeof(mrbc_value) * size );
+    }
+    if( !ivar ) return;	// ENOMEM
+    if( !ins->ivar ) mrbc_set_vm_id( ivar, mrbc_get_vm_id(ins) );
+
+    ins->ivar = ivar;
+    ins->ivar_size = size;
+  }
+
   mrbc_incref(v);
-  mrbc_kv_set( &obj->instance->ivar, sym_id, v );
+  ins->ivar[slot] = *v;
+  ins->shape = shape;
 }
 
 
@@ -260,14 +354,42 @@ void mrbc_instance_setiv(mrbc_value *obj, mrbc_sym sym_id, mrbc_value *v)
 */
 mrbc_value mrbc_instance_getiv(mrbc_value *obj, mrbc_sym sym_id)
 {
-  mrbc_value *v = mrbc_kv_get( &obj->instance->ivar, sym_id );
-  if( !v ) return mrbc_nil_value();
+  int slot = mrbc_shape_find_slot( obj->instance->shape, sym_id );
+  if( slot < 0 ) return mrbc_nil_value();
 
+  mrbc_value *v = &obj->instance->ivar[slot];
   mrbc_incref(v);
   return *v;
 }
 
 
+//================================================================
+/*! copy all instance variables.
+
+  @param  dst		pointer to destination, which has no ivar.
+  @param  src		pointer to source.
+*/
+void mrbc_instance_dup_ivar(mrbc_value *dst, const mrbc_value *src)
+{
+  mrbc_instance *d = dst->instance;
+  const mrbc_instance *s = src->instance;
+  int n = s->shape->n_slots;
+  if( n == 0 ) return;
+
+  d->ivar = mrbc_raw_alloc( sizeof(mrbc_value) * s->ivar_size );
+  if( !d->ivar ) return;	// ENOMEM
+  mrbc_set_vm_id( d->ivar, mrbc_get_vm_id(d) );
+  d->ivar_size = s->ivar_size;
+  d->shape = s->shape;
+
+  int i;
+  for( i = 0; i < n; i++ ) {
+    d->ivar[i] = s->ivar[i];
+    mrbc_incref( &d->ivar[i] );
+  }
+}
+
+
 #if defined(MRBC_ALLOC_VMID)
 //================================================================
 /*! clear vm_id
@@ -276,12 +398,36 @@ mrbc_value mrbc_instance_getiv(mrbc_value *obj, mrbc_sym sym_id)
 */
 void mrbc_instance_clear_vm_id(mrbc_value *v)
 {
-  mrbc_set_vm_id( v->instance, 0 );
-  mrbc_kv_clear_vm_id( &v->instance->ivar );
+  mrbc_instance *ins = v->instance;
+  mrbc_set_vm_id( ins, 0 );
+  if( !ins->ivar ) return;
+
+  mrbc_set_vm_id( ins->ivar, 0 );
+  int i;
+  for( i = 0; i < ins->shape->n_slots; i++ ) {
+    mrbc_clear_vm_id( &ins->ivar[i] );
+  }
 }
 #endif
 
 
+//================================================================
+/*! find the slot index of instance variable.
+
+  @param  shape		pointer to shape.
+  @param  sym_id	symbol ID of ivar.
+  @return		slot index, or -1 if not found.
+*/
+int mrbc_shape_find_slot(const mrbc_shape *shape, mrbc_sym sym_id)
+{
+  for( ; shape->n_slots != 0; shape = shape->parent ) {
+    if( shape->sym_id == sym_id ) return shape->n_slots - 1;
+  }
+
+  return -1;
+}
+
+
 //================================================================
 /*! proc constructor
 
@@ -293,7 +439,7 @@ mrbc_value mrbc_proc_new(struct VM *vm, void *irep)
 {
   mrbc_value val = {.tt = MRBC_TT_PROC};
 
-  val.proc = mrbc_alloc(vm, sizeof(mrbc_proc));
+  val.proc = mrbc_slab_alloc(vm, sizeof(mrbc_proc));
   if( !val.proc ) return val;	// ENOMEM
 
   MRBC_INIT_OBJECT_HEADER( val.proc, "PR" );
@@ -306,6 +452,9 @@ mrbc_value mrbc_proc_new(struct VM *vm, void *irep)
   }
 
   val.proc->irep = irep;
+#if defined(MRBC_USE_LAZY_IREP)
+  mrbc_irep_incref( val.proc->irep );
+#endif
 
   return val;
 }
@@ -318,7 +467,10 @@ mrbc_value mrbc_proc_new(struct VM *vm, void *irep)
 */
 void mrbc_proc_delete(mrbc_value *val)
 {
-  mrbc_raw_free(val->proc);
+#if defined(MRBC_USE_LAZY_IREP)
+  mrbc_irep_decref( val->proc->irep );
+#endif
+  mrbc_slab_free(val->proc, sizeof(mrbc_proc));
 }
 
 
@@ -407,6 +559,21 @@ mrbc_method * mrbc_find_method( mrbc_method *r_method, mrbc_class *cls, mrbc_sym
 }
 
 
+//================================================================
+/*! invalidate all inline method caches.
+
+  Call this after changing any method table.
+*/
+void mrbc_clear_method_cache(void)
+{
+  if( ++mrbc_method_cache_generation != 0x8000 ) return;
+
+  // wrapped around. the entries may hold the redefined methods.
+  mrbc_method_cache_generation = 1;
+  mrbc_clear_all_inline_cache();
+}
+
+
 //================================================================
 /*! get class by name
 
@@ -624,5 +791,17 @@ void mrbc_init_class(void)
   cls.cls = MRBC_CLASS(ZeroDivisionError);
   mrbc_set_const( MRBC_SYM(ZeroDivisionError), &cls );
 
+  cls.cls = MRBC_CLASS(SystemStackError);
+  mrbc_set_const( MRBC_SYM(SystemStackError), &cls );
+
+  cls.cls = MRBC_CLASS(U8Array);
+  mrbc_set_const( MRBC_SYM(U8Array), &cls );
+
+  cls.cls = MRBC_CLASS(U16Array);
+  mrbc_set_const( MRBC_SYM(U16Array), &cls );
+
+  cls.cls = MRBC_CLASS(U32Array);
+  mrbc_set_const( MRBC_SYM(U32Array), &cls );
+
   mrbc_run_mrblib(mrblib_bytecode);
 }
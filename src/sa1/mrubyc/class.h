@@ -71,6 +71,24 @@ struct RBuiltinClass {
 };
 
 
+//================================================================
+/*!@brief
+  Shape of instance variables. (hidden class)
+
+  Shapes make a transition tree from the empty root shape.
+  Each shape adds one instance variable to its parent, so objects that
+  set the same instance variables in the same order share a shape.
+*/
+typedef struct RShape {
+  struct RShape *parent;	//!< shape without the last ivar.
+  struct RShape *child;		//!< first transition.
+  struct RShape *sibling;	//!< next transition of the parent.
+  mrbc_sym sym_id;		//!< symbol ID of the last ivar.
+  uint8_t n_slots;		//!< num of ivars. (slot of sym_id is n_slots-1)
+  uint8_t max_slots;		//!< max n_slots of the descendants.
+} mrbc_shape;
+
+
 //================================================================
 /*!@brief
   Instance object.
@@ -81,7 +99,12 @@ typedef struct RInstance {
   MRBC_OBJECT_HEADER;
 
   struct RClass *cls;
-  struct RKeyValueHandle ivar;
+  struct RShape *shape;		//!< shape of ivars.
+  uint8_t ivar_size;		//!< size of ivar slots.
+  mrbc_value *ivar;		//!< ivar slots, ordered by the shape.
+#if defined(MRBC_USE_SLAB_ALLOC)
+  uint16_t data_size;		//!< size of data[], to release to the slab.
+#endif
   uint8_t data[];
 
 } mrbc_instance;
@@ -112,8 +135,10 @@ typedef struct RProc mrb_proc;
 */
 typedef struct RMethod {
   uint8_t type;		//!< M:OP_DEF or OP_ALIAS, m:mrblib or define_method()
-  uint8_t c_func;	//!< 0:IREP, 1:C Func, 2:C Func (built-in)
+  uint8_t c_func;	//!< 0:IREP, 1:C Func, 2:C Func (built-in),
+			//!< 3:attr reader, 4:attr writer
   mrbc_sym sym_id;	//!< function names symbol ID
+  mrbc_sym ivar_id;	//!< instance variable name for attr reader/writer.
   union {
     struct IREP *irep;	//!< to IREP for ruby proc.
     mrbc_func_t func;	//!< to C function.
@@ -152,25 +177,31 @@ extern struct RClass mrbc_class_RangeError;
 extern struct RClass mrbc_class_RuntimeError;
 extern struct RClass mrbc_class_TypeError;
 extern struct RClass mrbc_class_ZeroDivisionError;
+extern struct RClass mrbc_class_SystemStackError;
 
 // for old version compatibility.
 #define mrbc_class_object ((struct RClass*)(&mrbc_class_Object))
 
+extern uint16_t mrbc_method_cache_generation;
+
 
 /***** Function prototypes **************************************************/
 mrbc_class *mrbc_define_class(struct VM *vm, const char *name, mrbc_class *super);
 mrbc_class *mrbc_define_class_under(struct VM *vm, const mrbc_class *outer, const char *name, mrbc_class *super);
-void mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_func_t cfunc);
+mrbc_method *mrbc_define_method(struct VM *vm, mrbc_class *cls, const char *name, mrbc_func_t cfunc);
 mrbc_value mrbc_instance_new(struct VM *vm, mrbc_class *cls, int size);
 void mrbc_instance_delete(mrbc_value *v);
 void mrbc_instance_setiv(mrbc_value *obj, mrbc_sym sym_id, mrbc_value *v);
 mrbc_value mrbc_instance_getiv(mrbc_value *obj, mrbc_sym sym_id);
+void mrbc_instance_dup_ivar(mrbc_value *dst, const mrbc_value *src);
+int mrbc_shape_find_slot(const mrbc_shape *shape, mrbc_sym sym_id);
 void mrbc_instance_clear_vm_id(mrbc_value *v);
 mrbc_value mrbc_proc_new(struct VM *vm, void *irep);
 void mrbc_proc_delete(mrbc_value *val);
 void mrbc_proc_clear_vm_id(mrbc_value *v);
 int mrbc_obj_is_kind_of(const mrbc_value *obj, const mrbc_class *cls);
 mrbc_method *mrbc_find_method(mrbc_method *r_method, mrbc_class *cls, mrbc_sym sym_id);
+void mrbc_clear_method_cache(void);
 mrbc_class *mrbc_get_class_by_name(const char *name);
 mrbc_value mrbc_send(struct VM *vm, mrbc_value *v, int reg_ofs, mrbc_value *recv, const char *method_name, int argc, ...);
 void c_ineffect(struct VM *vm, mrbc_value v[], int argc);
@@ -50,7 +50,7 @@
 mrbc_value mrbc_exception_new(struct VM *vm, struct RClass *exc_cls, const void *message, int len )
 {
   // allocate memory.
-  mrbc_exception *ex = mrbc_alloc( vm, sizeof(mrbc_exception) );
+  mrbc_exception *ex = mrbc_slab_alloc( vm, sizeof(mrbc_exception) );
   if( !ex ) {		// ENOMEM
     return mrbc_nil_value();
   }
@@ -107,7 +107,7 @@ mrbc_value mrbc_exception_new(struct VM *vm, struct RClass *exc_cls, const void
 mrbc_value mrbc_exception_new_alloc(struct VM *vm, struct RClass *exc_cls, const void *message, int len )
 {
   // allocate memory.
-  mrbc_exception *ex = mrbc_alloc( vm, sizeof(mrbc_exception) );
+  mrbc_exception *ex = mrbc_slab_alloc( vm, sizeof(mrbc_exception) );
   if( !ex ) {		// ENOMEM
     return mrbc_nil_value();
   }
@@ -131,7 +131,7 @@ void mrbc_exception_delete(mrbc_value *value)
   if( value->exception->message_size ) {
     mrbc_raw_free( (void *)value->exception->message );
   }
-  mrbc_raw_free( value->exception );
+  mrbc_slab_free( value->exception, sizeof(mrbc_exception) );
 }
 
 
@@ -280,6 +280,7 @@ static void c_exception_message(struct VM *vm, mrbc_value v[], int argc)
         RuntimeError
         TypeError
         ZeroDivisionError
+      SystemStackError
 */
 
 /* MRBC_AUTOGEN_METHOD_TABLE
@@ -321,5 +322,8 @@ static void c_exception_message(struct VM *vm, mrbc_value v[], int argc)
 
   CLASS("ZeroDivisionError")
   SUPER("StandardError")
+
+  CLASS("SystemStackError")
+  SUPER("Exception")
 */
 #include "_autogen_class_exception.h"
@@ -15,25 +15,52 @@
 /***** System headers *******************************************************/
 //@cond
 #include "vm_config.h"
+#include <string.h>
 //@endcond
 
 /***** Local headers ********************************************************/
 #include "value.h"
+#include "alloc.h"
 #include "global.h"
 #include "keyvalue.h"
 #include "class.h"
 #include "symbol.h"
 #include "console.h"
+#include "vm.h"
 
 /***** Constat values *******************************************************/
+#define CLASS_CONST_SIZE_INCREMENT 8
+
 /***** Macros ***************************************************************/
 /***** Typedefs *************************************************************/
+//================================================================
+/*!@brief
+  Constant defined under a class.
+*/
+typedef struct RClassConst {
+  const struct RClass *cls;	//!< owner class.
+  mrbc_sym sym_id;		//!< constant name.
+  mrbc_value value;		//!< stored value.
+
+} mrbc_class_const;
+
+
 /***** Function prototypes **************************************************/
 /***** Local variables ******************************************************/
 static mrbc_kv_handle handle_const;	//!< for global(Object) constants.
 static mrbc_kv_handle handle_global;	//!< for global variables.
 
+//! class constants, sorted by (cls, sym_id).
+static struct {
+  uint16_t data_size;
+  uint16_t n_stored;
+  mrbc_class_const *data;
+} class_const;
+
 /***** Global variables *****************************************************/
+//! Generation of inline constant caches. (0x8000-0xffff, see vm.h)
+uint16_t mrbc_const_cache_generation = 0x8000;
+
 /***** Signal catching functions ********************************************/
 /***** Local functions ******************************************************/
 
@@ -63,6 +90,41 @@ static void make_nested_symbol_s( char *buf, mrbc_sym id1, mrbc_sym id2 )
 }
 
 
+//================================================================
+/*! compare class constant keys.
+*/
+static inline int class_const_cmp( const mrbc_class_const *c, const struct RClass *cls, mrbc_sym sym_id )
+{
+  if( c->cls != cls ) return (uintptr_t)c->cls < (uintptr_t)cls ? -1 : 1;
+  return c->sym_id - sym_id;
+}
+
+
+//================================================================
+/*! binary search class constant
+
+  @param  cls		class.
+  @param  sym_id	symbol ID.
+  @return		index of the first entry not less than the key.
+*/
+static int class_const_search( const struct RClass *cls, mrbc_sym sym_id )
+{
+  int left = 0;
+  int right = class_const.n_stored;
+
+  while( left < right ) {
+    int mid = (left + right) / 2;
+    if( class_const_cmp( &class_const.data[mid], cls, sym_id ) < 0 ) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+
+  return left;
+}
+
+
 /***** Global functions *****************************************************/
 
 //================================================================
@@ -88,6 +150,7 @@ int mrbc_set_const( mrbc_sym sym_id, mrbc_value *v )
     mrbc_printf("warning: already initialized constant.\n");
   }
 
+  mrbc_clear_const_cache();
   return mrbc_kv_set( &handle_const, sym_id, v );
 }
 
@@ -102,15 +165,60 @@ int mrbc_set_const( mrbc_sym sym_id, mrbc_value *v )
 */
 int mrbc_set_class_const( const struct RClass *cls, mrbc_sym sym_id, mrbc_value *v )
 {
-  char buf[sizeof(mrbc_sym)*4+1];
+  if( cls->sym_id == MRBC_SYM(Object) ) {
+    return mrbc_set_const( sym_id, v );
+  }
 
-  make_nested_symbol_s( buf, cls->sym_id, sym_id );
-  mrbc_sym id = mrbc_symbol( mrbc_symbol_new( 0, buf ));
   if( v->tt == MRBC_TT_CLASS ) {
+    // name the nested class "Outer::Name", and register it by the name
+    // to find the outer class from it. (see mrbc_get_class_const)
+    char buf[sizeof(mrbc_sym)*4+1];
+
+    make_nested_symbol_s( buf, cls->sym_id, sym_id );
+    mrbc_sym id = mrbc_symbol( mrbc_symbol_new( 0, buf ));
     v->cls->sym_id = id;
+    mrbc_kv_set( &handle_const, id, v );
   }
 
-  return mrbc_set_const( id, v );
+  mrbc_clear_const_cache();
+
+  // replace value ?
+  int idx = class_const_search( cls, sym_id );
+  mrbc_class_const *c = &class_const.data[idx];
+  if( idx < class_const.n_stored && class_const_cmp( c, cls, sym_id ) == 0 ) {
+    mrbc_printf("warning: already initialized constant.\n");
+    mrbc_decref( &c->value );
+    c->value = *v;
+    return 0;
+  }
+
+  // need resize?
+  if( class_const.n_stored >= class_const.data_size ) {
+    int size = class_const.data_size + CLASS_CONST_SIZE_INCREMENT;
+    mrbc_class_const *data;
+    if( class_const.data ) {
+      data = mrbc_raw_realloc( class_const.data, sizeof(mrbc_class_const) * size );
+    } else {
+      data = mrbc_raw_alloc( sizeof(mrbc_class_const) * size );
+    }
+    if( !data ) return E_NOMEMORY_ERROR;	// ENOMEM
+
+    class_const.data = data;
+    class_const.data_size = size;
+  }
+
+  // need move data?
+  c = &class_const.data[idx];
+  if( idx < class_const.n_stored ) {
+    memmove( c + 1, c, sizeof(mrbc_class_const) * (class_const.n_stored - idx) );
+  }
+
+  c->cls = cls;
+  c->sym_id = sym_id;
+  c->value = *v;
+  class_const.n_stored++;
+
+  return 0;
 }
 
 
@@ -140,18 +248,16 @@ mrbc_value * mrbc_get_class_const( const struct RClass *cls, mrbc_sym sym_id )
   }
 
   while( 1 ) {
-    char buf[sizeof(mrbc_sym)*4+1];
-
-    make_nested_symbol_s( buf, cls->sym_id, sym_id );
-    mrbc_sym id = mrbc_search_symid(buf);
-    if( id > 0 ) {
-      mrbc_value *v = mrbc_kv_get( &handle_const, id );
-      if( v ) return v;
+    int idx = class_const_search( cls, sym_id );
+    if( idx < class_const.n_stored ) {
+      mrbc_class_const *c = &class_const.data[idx];
+      if( class_const_cmp( c, cls, sym_id ) == 0 ) return &c->value;
     }
 
     // not found it in own class, traverses nested class.
     if( !mrbc_is_nested_symid(cls->sym_id) ) break;
 
+    mrbc_sym id;
     mrbc_separate_nested_symid( cls->sym_id, &id, 0 );
     mrbc_value *v = mrbc_kv_get( &handle_const, id );
     assert( v->tt == MRBC_TT_CLASS );
@@ -162,6 +268,21 @@ mrbc_value * mrbc_get_class_const( const struct RClass *cls, mrbc_sym sym_id )
 }
 
 
+//================================================================
+/*! invalidate all inline constant caches.
+
+  Call this before changing any constant.
+*/
+void mrbc_clear_const_cache(void)
+{
+  if( ++mrbc_const_cache_generation != 0 ) return;
+
+  // wrapped around. the entries may point to the freed constant table.
+  mrbc_const_cache_generation = 0x8000;
+  mrbc_clear_all_inline_cache();
+}
+
+
 //================================================================
 /*! setter global variable.
 
@@ -195,6 +316,15 @@ void mrbc_global_clear_vm_id(void)
 {
   mrbc_kv_clear_vm_id( &handle_const );
   mrbc_kv_clear_vm_id( &handle_global );
+
+  if( class_const.data ) {
+    mrbc_set_vm_id( class_const.data, 0 );
+
+    int i;
+    for( i = 0; i < class_const.n_stored; i++ ) {
+      mrbc_clear_vm_id( &class_const.data[i].value );
+    }
+  }
 }
 #endif
 
@@ -262,6 +392,22 @@ void mrbc_debug_dump_const( void )
       mrbc_printf(".tt=%d.ref=%d\n", mrbc_type(kv->value), kv->value.obj->ref_count);
     }
   }
+
+  int i;
+  for( i = 0; i < class_const.n_stored; i++ ) {
+    const mrbc_class_const *c = &class_const.data[i];
+    if( c->value.tt == MRBC_TT_CLASS ) continue;	// dumped above.
+
+    mrbc_printf(" ");
+    mrbc_print_nested_symbol( c->cls->sym_id );
+    mrbc_printf("::%s = ", mrbc_symid_to_str(c->sym_id));
+    mrbc_p_sub( &c->value );
+    if( mrbc_type(c->value) <= MRBC_TT_INC_DEC_THRESHOLD ) {
+      mrbc_printf(".tt=%d\n", mrbc_type(c->value));
+    } else {
+      mrbc_printf(".tt=%d.ref=%d\n", mrbc_type(c->value), c->value.obj->ref_count);
+    }
+  }
 }
 
 
@@ -27,12 +27,15 @@ extern "C" {
 /***** Macros ***************************************************************/
 /***** Typedefs *************************************************************/
 /***** Global variables *****************************************************/
+extern uint16_t mrbc_const_cache_generation;
+
 /***** Function prototypes **************************************************/
 void mrbc_init_global(void);
 int mrbc_set_const(mrbc_sym sym_id, mrbc_value *v);
 int mrbc_set_class_const(const struct RClass *cls, mrbc_sym sym_id, mrbc_value *v);
 mrbc_value *mrbc_get_const(mrbc_sym sym_id);
 mrbc_value *mrbc_get_class_const(const struct RClass *cls, mrbc_sym sym_id);
+void mrbc_clear_const_cache(void);
 int mrbc_set_global(mrbc_sym sym_id, mrbc_value *v);
 mrbc_value *mrbc_get_global(mrbc_sym sym_id);
 void mrbc_global_clear_vm_id(void);
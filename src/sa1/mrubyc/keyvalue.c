@@ -76,11 +76,11 @@ static int binary_search(mrbc_kv_handle *kvh, mrbc_sym sym_id)
 */
 mrbc_kv_handle * mrbc_kv_new(struct VM *vm, int size)
 {
-  mrbc_kv_handle *kvh = mrbc_alloc(vm, sizeof(mrbc_kv_handle));
+  mrbc_kv_handle *kvh = mrbc_slab_alloc(vm, sizeof(mrbc_kv_handle));
   if( !kvh ) return NULL;	// ENOMEM
 
   if( mrbc_kv_init_handle( vm, kvh, size ) != 0 ) {
-    mrbc_raw_free( kvh );
+    mrbc_slab_free( kvh, sizeof(mrbc_kv_handle) );
     return NULL;
   }
 
@@ -127,7 +127,7 @@ int mrbc_kv_init_handle(struct VM *vm, mrbc_kv_handle *kvh, int size)
 void mrbc_kv_delete(mrbc_kv_handle *kvh)
 {
   mrbc_kv_delete_data(kvh);
-  mrbc_raw_free(kvh);
+  mrbc_slab_free(kvh, sizeof(mrbc_kv_handle));
 }
 
 
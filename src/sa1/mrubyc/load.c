@@ -17,6 +17,7 @@
 #include "vm_config.h"
 #include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
 // FIXME: error: 'UINT16_MAX' undeclared
 # define UINT16_MAX (65535)
 #include <string.h>
@@ -30,7 +31,9 @@
 #include "symbol.h"
 #include "error.h"
 #include "c_string.h"
+#include "console.h"
 #include "load.h"
+#include "opcode.h"
 
 
 /***** Constat values *******************************************************/
@@ -42,6 +45,10 @@ static const int SIZE_RITE_SECTION_HEADER = 12;
 static const int SIZE_RITE_CATCH_HANDLER = 13;
 static const char IREP[4] = "IREP";
 static const char END[4] = "END\0";
+#if defined(MRBC_USE_COMPRESSED_IREP)
+static const char IRPZ[4] = "IRPZ";	// compressed IREP section.
+static const int SIZE_IRPZ_BLOCK_HEADER = 12;
+#endif
 
 
 /*! IREP TT */
@@ -61,6 +68,195 @@ enum irep_pool_type {
 /***** Global variables *****************************************************/
 /***** Signal catching functions ********************************************/
 /***** Local functions ******************************************************/
+#if defined(MRBC_USE_SUPERINSTRUCTIONS)
+//================================================================
+/*! get the size of operands.
+
+  @param  op	opcode.
+  @param  ext	1..3 if prefixed by OP_EXT1..3, or 0.
+  @return	size in bytes, or -1 if unknown opcode.
+*/
+static int operand_size(int op, int ext)
+{
+  int ext_a = ext & 1;
+  int ext_b = (ext >> 1) & 1;
+
+  switch( op ) {
+  case OP_NOP: case OP_CALL: case OP_KEYEND: case OP_STOP:
+  case OP_EXT1: case OP_EXT2: case OP_EXT3:
+    return 0;				// Z
+
+  case OP_LOADI__1: case OP_LOADI_0: case OP_LOADI_1: case OP_LOADI_2:
+  case OP_LOADI_3: case OP_LOADI_4: case OP_LOADI_5: case OP_LOADI_6:
+  case OP_LOADI_7: case OP_LOADNIL: case OP_LOADSELF: case OP_LOADT:
+  case OP_LOADF: case OP_GETIDX: case OP_SETIDX: case OP_EXCEPT:
+  case OP_RAISEIF: case OP_RETURN: case OP_RETURN_BLK: case OP_BREAK:
+  case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_EQ:
+  case OP_LT: case OP_LE: case OP_GT: case OP_GE: case OP_ARYCAT:
+  case OP_ARYDUP: case OP_INTERN: case OP_STRCAT: case OP_HASHCAT:
+  case OP_RANGE_INC: case OP_RANGE_EXC: case OP_OCLASS: case OP_UNDEF:
+  case OP_SCLASS: case OP_TCLASS: case OP_ERR:
+    return 1 + ext_a;			// B
+
+  case OP_MOVE: case OP_LOADL: case OP_LOADI: case OP_LOADINEG:
+  case OP_LOADSYM: case OP_GETGV: case OP_SETGV: case OP_GETSV:
+  case OP_SETSV: case OP_GETIV: case OP_SETIV: case OP_GETCV:
+  case OP_SETCV: case OP_GETCONST: case OP_SETCONST: case OP_GETMCNST:
+  case OP_SETMCNST: case OP_RESCUE: case OP_SUPER: case OP_KEY_P:
+  case OP_KARG: case OP_ADDI: case OP_SUBI: case OP_ARRAY:
+  case OP_ARYPUSH: case OP_SYMBOL: case OP_STRING: case OP_HASH:
+  case OP_HASHADD: case OP_LAMBDA: case OP_BLOCK: case OP_METHOD:
+  case OP_CLASS: case OP_MODULE: case OP_EXEC: case OP_DEF:
+  case OP_ALIAS:
+    return 2 + ext_a + ext_b;		// BB
+
+  case OP_GETUPVAR: case OP_SETUPVAR: case OP_SSEND: case OP_SSENDB:
+  case OP_SEND: case OP_SENDB: case OP_ARRAY2: case OP_AREF:
+  case OP_ASET: case OP_APOST: case OP_DEBUG:
+    return 3 + ext_a + ext_b;		// BBB
+
+  case OP_LOADI16: case OP_JMPIF: case OP_JMPNOT: case OP_JMPNIL:
+  case OP_ARGARY: case OP_BLKPUSH:
+    return 3 + ext_a;			// BS
+
+  case OP_LOADI32:
+    return 5 + ext_a;			// BSS
+
+  case OP_JMP: case OP_JMPUW:
+    return 2;				// S
+
+  case OP_ENTER:
+    return 3;				// W
+  }
+
+  return -1;
+}
+
+
+//================================================================
+/*! rewrite the first opcode of a sequence to a superinstruction.
+
+  @param  p	pointer to the first instruction. (not prefixed by OP_EXT)
+  @param  end	end of instructions.
+*/
+static void fuse_sequence(uint8_t *p, const uint8_t *end)
+{
+  const uint8_t *q = p + 1 + operand_size(p[0], 0);	// next instruction
+  const uint8_t *r;
+
+  switch( p[0] ) {
+  case OP_EQ: case OP_LT: case OP_LE: case OP_GT: case OP_GE:
+    // compare and branch by the result.
+    if( q + 4 > end || q[1] != p[1] ) break;
+    if( q[0] == OP_JMPIF ) {
+      p[0] = OP_EQ_JMPIF + (p[0] - OP_EQ) * 2;
+    } else if( q[0] == OP_JMPNOT ) {
+      p[0] = OP_EQ_JMPNOT + (p[0] - OP_EQ) * 2;
+    }
+    break;
+
+  case OP_LOADI16:
+    // add a constant that doesn't fit in OP_ADDI.
+    // (mrbc makes OP_ADDI of a constant in 8 bits, not OP_LOADI + OP_ADD)
+    if( q + 2 > end || q[0] != OP_ADD || p[1] != q[1] + 1 ) break;
+    p[0] = OP_LOADI16_ADD;
+    break;
+
+  case OP_GETIV:
+    // @ivar += n
+    r = q + 3;
+    if( r + 3 > end || q[0] != OP_ADDI || q[1] != p[1] ) break;
+    if( r[0] != OP_SETIV || r[1] != p[1] || r[2] != p[2] ) break;
+    p[0] = OP_GETIV_ADDI_SETIV;
+    break;
+
+  case OP_MOVE:
+    // set an argument or a receiver, and call.
+    if( q + 4 > end || q[0] != OP_SEND ) break;
+    p[0] = OP_MOVE_SEND;
+    break;
+  }
+}
+
+
+//================================================================
+/*! rewrite frequent instruction sequences to superinstructions.
+
+  @param  inst	pointer to instructions. (copied to RAM)
+  @param  ilen	size of instructions.
+*/
+static void fuse_instructions(uint8_t *inst, uint32_t ilen)
+{
+  const uint8_t *end = inst + ilen;
+  int ext = 0;
+
+  while( inst < end ) {
+    int op = inst[0];
+    int siz = operand_size(op, ext);
+    if( siz < 0 ) return;	// unknown opcode. leave the rest as is.
+
+    if( OP_EXT1 <= op && op <= OP_EXT3 ) {
+      ext = op - OP_EXT1 + 1;
+      inst++;
+      continue;
+    }
+
+    if( ext == 0 ) fuse_sequence( inst, end );
+    ext = 0;
+    inst += 1 + siz;
+  }
+}
+#endif
+
+
+#if defined(MRBC_USE_COMPRESSED_IREP)
+//================================================================
+/*! inflate LZ4 block. (made by support/mrbc_compress.rb)
+
+  @param  dst		destination buffer.
+  @param  size		size of inflated data.
+  @param  src		LZ4 block.
+  @param  src_size	size of LZ4 block.
+  @return		zero if no error.
+*/
+static int lz4_inflate(uint8_t *dst, int size, const uint8_t *src, int src_size)
+{
+  uint8_t *d = dst;
+  uint8_t *d_end = dst + size;
+  const uint8_t *s_end = src + src_size;
+
+  while( src < s_end ) {
+    int token = *src++;
+    int n = token >> 4;
+    int c;
+
+    // literals
+    if( n == 15 ) {
+      do { c = *src++; n += c; } while( c == 255 );
+    }
+    if( d + n > d_end || src + n > s_end ) return -1;
+    memcpy( d, src, n );
+    d += n;
+    src += n;
+    if( src == s_end ) break;	// last sequence has literals only.
+
+    // match. (may overlap)
+    const uint8_t *m = d - (src[0] | (uint16_t)src[1] << 8);
+    src += 2;
+    if( m < dst || m == d ) return -1;
+    n = token & 0x0f;
+    if( n == 15 ) {
+      do { c = *src++; n += c; } while( c == 255 );
+    }
+    n += 4;
+    if( d + n > d_end ) return -1;
+    while( n-- > 0 ) *d++ = *m++;
+  }
+
+  return d == d_end ? 0 : -1;
+}
+#endif
+
 
 //================================================================
 /*! Parse header section.
@@ -135,31 +331,45 @@ static int load_header(struct VM *vm, const uint8_t *bin)
      0000	length
      ...	symbol data
   </pre>
+
+  <pre>
+   (compressed IREP section, loop n of child irep below)
+   0000_0000	block size
+   0000_0000	size of inflated record
+   0000		n of child irep
+   0000		n of pool
+   ...		SYMS BLOCK  (not compressed, symbols refer to it)
+   ...		LZ4 block of the record above, without SYMS BLOCK.
+  </pre>
 */
 static mrbc_irep * load_irep_1(struct VM *vm, const uint8_t *bin, int *len, int flag_top)
 {
   mrbc_irep irep;
-  const uint8_t *p = bin + 4;	// 4 = skip record size.
+  const uint8_t *rec = bin;	// IREP record. (ISEQ and POOL block)
+  const uint8_t *p;
+  int siz_ram = 0;		// size of the record copied to RAM.
   int i;
 
-#if defined(MRBC_DEBUG)
-  irep.type[0] = 'R';	// set "RP"
-  irep.type[1] = 'P';
+#if defined(MRBC_USE_COMPRESSED_IREP)
+  if( vm->flag_compressed ) {
+    siz_ram = bin_to_uint32(bin + 4);
+    irep.rlen = bin_to_uint16(bin + 8);
+    irep.plen = bin_to_uint16(bin + 10);
+    p = bin + SIZE_IRPZ_BLOCK_HEADER;
+    goto SYMS_BLOCK;
+  }
 #endif
 
-  irep.nlocals = bin_to_uint16(p);	p += 2;
-  irep.nregs = bin_to_uint16(p);	p += 2;
-  irep.rlen = bin_to_uint16(p);		p += 2;
-  irep.clen = bin_to_uint16(p);		p += 2;
-  irep.ilen = bin_to_uint32(p);		p += 4;
-  irep.inst = p;
-
-  // POOL block
-  p += irep.ilen + SIZE_RITE_CATCH_HANDLER * irep.clen;
-  irep.pool = p;
-  irep.plen = bin_to_uint16(p);		p += 2;
+  irep.rlen = bin_to_uint16(bin + 8);
+  irep.ilen = bin_to_uint32(bin + 12);
+  p = bin + 16 + irep.ilen + SIZE_RITE_CATCH_HANDLER * bin_to_uint16(bin + 10);
+#if defined(MRBC_USE_SUPERINSTRUCTIONS)
+  // instructions and catch handlers are copied to RAM to be rewritten.
+  siz_ram = p - (bin + 16);
+#endif
 
   // skip pool
+  irep.plen = bin_to_uint16(p);		p += 2;
   for( i = 0; i < irep.plen; i++ ) {
     int siz = 0;
     switch( *p++ ) {
@@ -178,48 +388,113 @@ static mrbc_irep * load_irep_1(struct VM *vm, const uint8_t *bin, int *len, int
     p += siz;
   }
 
-  // num of symbols, offset of tbl_ireps.
+#if defined(MRBC_USE_COMPRESSED_IREP)
+ SYMS_BLOCK:
+#endif
+  // num of symbols.
   irep.slen = bin_to_uint16(p);		p += 2;
-  int siz = sizeof(mrbc_sym) * irep.slen + sizeof(uint16_t) * irep.plen;
+  int siz = sizeof(mrbc_sym) * irep.slen * 2 + sizeof(uint16_t) * irep.plen;
   siz += (-siz & 0x03);	// padding. 32bit align.
-  irep.ofs_ireps = siz >> 2;
+  int ofs_ireps = siz;
 
   // allocate new irep
   mrbc_irep *p_irep;
-  siz = sizeof(mrbc_irep) + siz + sizeof(mrbc_irep*) * irep.rlen;
+  siz = sizeof(mrbc_irep) + siz + sizeof(mrbc_irep*) * irep.rlen
+    + sizeof(mrbc_irep_cache) * irep.slen + siz_ram;
   if( vm->vm_id == 0 && !flag_top ) {
     p_irep = mrbc_raw_alloc_no_free( siz );
   } else {
     p_irep = mrbc_raw_alloc( siz );
+#if defined(MRBC_USE_LAZY_IREP)
+    if( !p_irep && mrbc_irep_evict(vm) ) p_irep = mrbc_raw_alloc( siz );
+#endif
   }
   if( !p_irep ) {	// ENOMEM
     mrbc_raise(vm, MRBC_CLASS(NoMemoryError),0);
     return NULL;
   }
-  *p_irep = irep;
 
-  // make a sym_id table.
-  mrbc_sym *tbl_syms = mrbc_irep_tbl_syms(p_irep);
+  // set the tables in data[].
+  mrbc_sym *tbl_syms = (mrbc_sym *)p_irep->data;
+  mrbc_sym *tbl_ivars = tbl_syms + irep.slen;
+  uint16_t *ofs_pools = (uint16_t *)(tbl_ivars + irep.slen);
+  mrbc_irep **tbl_ireps = (mrbc_irep **)(p_irep->data + ofs_ireps);
+  mrbc_irep_cache *tbl_cache = (mrbc_irep_cache *)(tbl_ireps + irep.rlen);
+  irep.tbl_syms = tbl_syms;
+  irep.tbl_pools = ofs_pools;
+  irep.tbl_ireps = tbl_ireps;
+  irep.tbl_cache = tbl_cache;
+#if defined(MRBC_USE_LAZY_IREP)
+  irep.index = NULL;
+  irep.ref_count = 0;
+#endif
+
+  // clear the child irep table and the inline cache.
+  memset( tbl_ireps, 0,
+	  sizeof(mrbc_irep*) * irep.rlen + sizeof(mrbc_irep_cache) * irep.slen );
+
+  // make a sym_id table, and instance variable's sym_id table.
   for( i = 0; i < irep.slen; i++ ) {
     int siz = bin_to_uint16(p);	p += 2;
     mrbc_sym sym = mrbc_str_to_symid( (const char *)p );
-    if( sym < 0 ) {
-      mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow MAX_SYMBOLS_COUNT");
-      return NULL;
-    }
+    if( sym < 0 ) goto OVERFLOW_SYMBOLS;
     *tbl_syms++ = sym;
+
+    // instance variable "@name" is stored as "name".
+    sym = -1;
+    if( p[0] == '@' && p[1] != '@' ) {
+      sym = mrbc_str_to_symid( (const char *)p + 1 );
+      if( sym < 0 ) goto OVERFLOW_SYMBOLS;
+    }
+    *tbl_ivars++ = sym;
     p += (siz+1);
   }
 
+#if defined(MRBC_USE_COMPRESSED_IREP)
+  // inflate the record, which follows the SYMS block.
+  if( vm->flag_compressed ) {
+    uint8_t *ram = (uint8_t *)(tbl_cache + irep.slen);
+    if( lz4_inflate( ram, siz_ram, p, bin + bin_to_uint32(bin) - p ) != 0 ) {
+      mrbc_raise(vm, MRBC_CLASS(Exception), "Broken compressed IREP.");
+      goto ERROR_RETURN;
+    }
+    rec = ram;
+  }
+#endif
+
+#if defined(MRBC_DEBUG)
+  irep.type[0] = 'R';	// set "RP"
+  irep.type[1] = 'P';
+#endif
+
+  p = rec + 4;	// 4 = skip record size.
+  irep.nlocals = bin_to_uint16(p);	p += 2;
+  irep.nregs = bin_to_uint16(p);	p += 2;
+  p += 2;	// rlen
+  irep.clen = bin_to_uint16(p);		p += 2;
+  irep.ilen = bin_to_uint32(p);		p += 4;
+  irep.inst = p;
+  irep.pool = p + irep.ilen + SIZE_RITE_CATCH_HANDLER * irep.clen;
+
+#if defined(MRBC_USE_SUPERINSTRUCTIONS)
+  if( rec == bin ) {
+    uint8_t *ram = (uint8_t *)(tbl_cache + irep.slen);
+    memcpy( ram, irep.inst, siz_ram );
+    irep.inst = ram;
+  }
+  fuse_instructions( (uint8_t *)irep.inst, irep.ilen );
+#endif
+  // copy the header only. trailing padding of the struct overlaps data[].
+  memcpy( p_irep, &irep, offsetof(mrbc_irep, data) );
+
   // make a pool data's offset table.
-  uint16_t *ofs_pools = mrbc_irep_tbl_pools(p_irep);
-  p = p_irep->pool + 2;
+  p = irep.pool + 2;
   for( i = 0; i < irep.plen; i++ ) {
     int siz = 0;
     // FIXME: 左の項を long long にキャストしないと正しく比較できない
     if( (long long)(p - irep.pool) > UINT16_MAX ) {
       mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow IREP data offset table.");
-      return NULL;
+      goto ERROR_RETURN;
     }
     *ofs_pools++ = (uint16_t)(p - irep.pool);
     switch( *p++ ) {
@@ -235,6 +510,12 @@ static mrbc_irep * load_irep_1(struct VM *vm, const uint8_t *bin, int *len, int
   // return length
   *len = bin_to_uint32(bin);
   return p_irep;
+
+ OVERFLOW_SYMBOLS:
+  mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow MAX_SYMBOLS_COUNT");
+ ERROR_RETURN:
+  if( !(vm->vm_id == 0 && !flag_top) ) mrbc_raw_free( p_irep );
+  return NULL;
 }
 
 
@@ -253,7 +534,7 @@ static mrbc_irep *load_irep(struct VM *vm, const uint8_t *bin, int *len)
   if( !irep ) return NULL;
   int total_len = len1;
 
-  mrbc_irep **tbl_ireps = mrbc_irep_tbl_ireps(irep);
+  mrbc_irep **tbl_ireps = (mrbc_irep **)mrbc_irep_tbl_ireps(irep);
   int i;
   for( i = 0; i < irep->rlen; i++ ) {
     tbl_ireps[i] = load_irep(vm, bin + total_len, &len1);
@@ -266,6 +547,137 @@ static mrbc_irep *load_irep(struct VM *vm, const uint8_t *bin, int *len)
 }
 
 
+#if defined(MRBC_USE_LAZY_IREP)
+//================================================================
+/*! make the IREP index, by scanning only the record headers.
+
+  The compressed IREP block has the size and the num of children
+  at the same offsets as the IREP record.
+
+  @param  index	Pointer to IREP index to write, or NULL to count only.
+  @param  bin	A pointer to RITE ISEQ.
+  @param  len	Returns the parsed length.
+  @return	num of IREPs in this subtree.
+*/
+static int make_irep_index(mrbc_irep_index *index, const uint8_t *bin, int *len)
+{
+  int rlen = bin_to_uint16(bin + 8);	// 8 = record size, nlocals, nregs.
+  int total_len = bin_to_uint32(bin);
+  int n = 1;
+  int i;
+
+  for( i = 0; i < rlen; i++ ) {
+    int len1;
+    n += make_irep_index( index ? index + n : NULL, bin + total_len, &len1 );
+    total_len += len1;
+  }
+
+  if( index ) {
+    index->bin = bin;
+    index->n_ireps = n;
+  }
+  *len = total_len;
+  return n;
+}
+
+
+//================================================================
+/*! Load the top level IREP only. Children are loaded at the first use.
+
+  @param  vm	A pointer to VM.
+  @param  bin	A pointer to RITE ISEQ.
+  @return	Pointer to allocated mrbc_irep or NULL
+*/
+static mrbc_irep *load_irep_lazy(struct VM *vm, const uint8_t *bin)
+{
+  int len;
+  int n = make_irep_index( NULL, bin, &len );
+  mrbc_irep_index *index = mrbc_raw_alloc( sizeof(mrbc_irep_index) * n );
+  if( !index ) {	// ENOMEM
+    mrbc_raise(vm, MRBC_CLASS(NoMemoryError),0);
+    return NULL;
+  }
+  make_irep_index( index, bin, &len );
+
+  mrbc_irep *irep = load_irep_1(vm, bin, &len, 1);
+  if( !irep ) {
+    mrbc_raw_free( index );
+    return NULL;
+  }
+  irep->index = index;
+
+  return irep;
+}
+
+
+//================================================================
+/*! check the IREP is running in the VM.
+*/
+static int irep_in_use(const struct VM *vm, const mrbc_irep *irep)
+{
+  if( vm->cur_irep == irep ) return 1;
+
+  const mrbc_callinfo *callinfo;
+  for( callinfo = vm->callinfo_tail; callinfo; callinfo = callinfo->prev ) {
+    if( callinfo->cur_irep == irep ) return 1;
+  }
+
+  return 0;
+}
+
+
+//================================================================
+/*! evict the unused children of IREP. (depth first)
+
+  @param  vm		A pointer to VM.
+  @param  irep		Pointer to IREP.
+  @param  n_evicted	num of evicted IREPs is added.
+  @return		num of children still loaded.
+*/
+static int evict_irep_children(const struct VM *vm, mrbc_irep *irep, int *n_evicted)
+{
+  mrbc_irep **tbl_ireps = (mrbc_irep **)mrbc_irep_tbl_ireps(irep);
+  int n_loaded = 0;
+  int i;
+
+  for( i = 0; i < irep->rlen; i++ ) {
+    mrbc_irep *child = tbl_ireps[i];
+    if( !child ) continue;
+
+    // a parent stays while its children are loaded.
+    if( evict_irep_children( vm, child, n_evicted ) == 0 &&
+	child->ref_count == 0 && !irep_in_use( vm, child ) ) {
+      mrbc_raw_free( child );
+      tbl_ireps[i] = NULL;
+      (*n_evicted)++;
+    } else {
+      n_loaded++;
+    }
+  }
+
+  return n_loaded;
+}
+#endif
+
+
+//================================================================
+/*! release mrbc_irep and its children.
+
+  @param  irep	Pointer to allocated mrbc_irep.
+*/
+static void free_irep(struct IREP *irep)
+{
+  // release child ireps.
+  mrbc_irep * const *tbl_ireps = mrbc_irep_tbl_ireps(irep);
+  int i;
+  for( i = 0; i < irep->rlen; i++ ) {
+    if( tbl_ireps[i] ) free_irep( tbl_ireps[i] );	// NULL if not loaded.
+  }
+
+  mrbc_raw_free( irep );
+}
+
+
 /***** Global functions *****************************************************/
 
 //================================================================
@@ -288,6 +700,11 @@ int mrbc_load_mrb(struct VM *vm, const void *bytecode)
     if( memcmp(bin, IREP, sizeof(IREP)) == 0 ) {
       if( mrbc_load_irep( vm, bin ) != 0 ) break;
 
+#if defined(MRBC_USE_COMPRESSED_IREP)
+    } else if( memcmp(bin, IRPZ, sizeof(IRPZ)) == 0 ) {
+      if( mrbc_load_irep( vm, bin ) != 0 ) break;
+#endif
+
     } else if( memcmp(bin, END, sizeof(END)) == 0 ) {
       break;
     }
@@ -304,13 +721,25 @@ int mrbc_load_mrb(struct VM *vm, const void *bytecode)
 /*! Load the IREP section.
 
   @param  vm		Pointer to VM.
-  @param  bytecode	Pointer to IREP section.
+  @param  bytecode	Pointer to IREP section, or compressed IREP section.
   @return int		zero if no error.
 */
 int mrbc_load_irep(struct VM *vm, const void *bytecode)
 {
   const uint8_t *bin = bytecode;
 
+  vm->flag_prelinked = 0;
+#if defined(MRBC_USE_COMPRESSED_IREP)
+  vm->flag_compressed = (memcmp(bin, IRPZ, sizeof(IRPZ)) == 0);
+#endif
+#if defined(MRBC_USE_LAZY_IREP)
+  // mrblib (vm_id == 0) stays forever, so it's loaded all at once.
+  if( vm->vm_id != 0 ) {
+    vm->top_irep = load_irep_lazy( vm, bin + SIZE_RITE_SECTION_HEADER );
+    if( vm->top_irep == NULL ) return -1;
+    return mrbc_israised(vm);
+  }
+#endif
   vm->top_irep = load_irep( vm, bin + SIZE_RITE_SECTION_HEADER, 0 );
   if( vm->top_irep == NULL ) return -1;
 
@@ -319,21 +748,190 @@ int mrbc_load_irep(struct VM *vm, const void *bytecode)
 
 
 
+#if defined(MRBC_USE_LAZY_IREP)
 //================================================================
-/*! release mrbc_irep holds memory
+/*! Load the n'th child IREP at the first use.
 
-  @param  irep	Pointer to allocated mrbc_irep.
+  @param  vm	Pointer to VM.
+  @param  irep	Pointer to parent IREP, loaded by lazy.
+  @param  n	n'th child.
+  @return	Pointer to child IREP, or NULL if error.
 */
-void mrbc_irep_free(struct IREP *irep)
+mrbc_irep *mrbc_load_child_irep(struct VM *vm, const mrbc_irep *irep, int n)
 {
-  // release child ireps.
-  mrbc_irep **tbl_ireps = mrbc_irep_tbl_ireps(irep);
+  const mrbc_irep_index *index = irep->index + 1;
+  int i;
+  for( i = 0; i < n; i++ ) {
+    index += index->n_ireps;
+  }
+
+  int len;
+  mrbc_irep *child = load_irep_1(vm, index->bin, &len, 0);
+  if( !child ) return NULL;
+  child->index = index;
+
+  ((mrbc_irep **)mrbc_irep_tbl_ireps(irep))[n] = child;
+  return child;
+}
+
+
+//================================================================
+/*! Evict the IREPs not in use, to release memory.
+
+  IREPs referred by Proc or method, or running in the VM aren't evicted.
+  Evicted IREP will be loaded again at the next use.
+
+  @param  vm	Pointer to VM.
+  @return int	num of evicted IREPs.
+*/
+int mrbc_irep_evict(struct VM *vm)
+{
+  int n_evicted = 0;
+
+  if( vm->top_irep && vm->top_irep->index ) {
+    evict_irep_children( vm, vm->top_irep, &n_evicted );
+  }
+
+  return n_evicted;
+}
+#endif
+
+
+#if defined(MRBC_USE_COMPRESSED_IREP)
+//================================================================
+/*! Get the n'th block of compressed IREP section. (for profiling)
+
+  @param  bytecode	Pointer to bytecode. (full .mrb file)
+  @param  n		n'th IREP, in order of the records.
+  @param  rom_size	Returns the size of the block.
+  @param  ram_size	Returns the size of the inflated record.
+  @return		Pointer to the block, or NULL if not found.
+*/
+const void *mrbc_compressed_irep_block(const void *bytecode, int n, int *rom_size, int *ram_size)
+{
+  const uint8_t *bin = (const uint8_t *)bytecode + SIZE_RITE_BINARY_HEADER;
+
+  while( memcmp(bin, IRPZ, sizeof(IRPZ)) != 0 ) {
+    if( memcmp(bin, END, sizeof(END)) == 0 ) return NULL;
+    bin += bin_to_uint32(bin+4);
+  }
+  const uint8_t *end = bin + bin_to_uint32(bin+4);
+
+  bin += SIZE_RITE_SECTION_HEADER;
+  while( n-- > 0 ) {
+    bin += bin_to_uint32(bin);
+    if( bin >= end ) return NULL;
+  }
+
+  *rom_size = bin_to_uint32(bin);
+  *ram_size = bin_to_uint32(bin + 4);
+  return bin;
+}
+
+
+//================================================================
+/*! Inflate the record in compressed IREP block. (for profiling)
+
+  @param  block		Pointer to the block.
+  @param  buf		Buffer for the inflated record.
+  @return int		zero if no error.
+*/
+int mrbc_inflate_irep_block(const void *block, uint8_t *buf)
+{
+  const uint8_t *bin = block;
+  const uint8_t *p = bin + SIZE_IRPZ_BLOCK_HEADER;
+  int slen = bin_to_uint16(p);
+  p += 2;
+
+  // skip SYMS block
+  while( slen-- > 0 ) {
+    p += 2 + bin_to_uint16(p) + 1;
+  }
+
+  return lz4_inflate( buf, bin_to_uint32(bin + 4), p, bin + bin_to_uint32(bin) - p );
+}
+#endif
+
+
+//================================================================
+/*! Register the symbols of pre-linked IREP.
+
+  Call this after mrbc_init_global() and before mrbc_init_class(),
+  so that the symbol IDs are the same as assigned by mrbc_prelink.rb.
+
+  @param  prelinked	Pointer to pre-linked IREP tree.
+  @return int		zero if no error.
+*/
+int mrbc_prelink_symbols(const mrbc_prelinked *prelinked)
+{
+  if( prelinked->n_symbols == 0 ) return 0;
+
+  mrbc_sym sym_id = mrbc_add_symbols( prelinked->symbols, prelinked->n_symbols );
+  if( sym_id != prelinked->sym_id_base ) {
+    mrbc_printf("Symbol ID mismatch. (pre-linked IREP)\n");
+    return -1;
+  }
+
+  return 0;
+}
+
+
+//================================================================
+/*! clear the inline caches of IREP tree.
+
+  @param  irep	Pointer to IREP.
+*/
+void mrbc_irep_clear_cache(const mrbc_irep *irep)
+{
+  memset( irep->tbl_cache, 0, sizeof(mrbc_irep_cache) * irep->slen );
+
   int i;
   for( i = 0; i < irep->rlen; i++ ) {
-    mrbc_irep_free( *tbl_ireps++ );
+    const mrbc_irep *child = mrbc_irep_child_irep(irep, i);
+    if( child ) mrbc_irep_clear_cache( child );	// NULL if not loaded.
   }
+}
 
-  mrbc_raw_free( irep );
+
+//================================================================
+/*! Load the pre-linked IREP tree.
+
+  Nothing is allocated. The IREP tree stays in ROM, and isn't freed
+  by mrbc_vm_close().
+
+  @param  vm		Pointer to VM.
+  @param  prelinked	Pointer to pre-linked IREP tree.
+  @return int		zero if no error.
+*/
+int mrbc_load_prelinked(struct VM *vm, const mrbc_prelinked *prelinked)
+{
+  vm->exception = mrbc_nil_value();
+  mrbc_irep_clear_cache( prelinked->top_irep );
+
+  vm->flag_prelinked = 1;
+  vm->top_irep = (mrbc_irep *)prelinked->top_irep;
+
+  return 0;
+}
+
+
+//================================================================
+/*! release mrbc_irep holds memory
+
+  @param  irep	Pointer to allocated top level mrbc_irep.
+*/
+void mrbc_irep_free(struct IREP *irep)
+{
+#if defined(MRBC_USE_LAZY_IREP)
+  // the index of top level irep is the whole index table.
+  const mrbc_irep_index *index = irep->index;
+#endif
+
+  free_irep( irep );
+
+#if defined(MRBC_USE_LAZY_IREP)
+  if( index ) mrbc_raw_free( (void *)index );
+#endif
 }
 
 
@@ -29,11 +29,34 @@ extern "C" {
 /***** Constat values *******************************************************/
 /***** Macros ***************************************************************/
 /***** Typedefs *************************************************************/
+//================================================================
+/*!@brief
+  Pre-linked IREP tree.
+
+  Made from .mrb file by support/mrbc_prelink.rb, and placed in ROM.
+  Symbols are resolved to the IDs, which are registered at boot
+  by mrbc_prelink_symbols().
+*/
+typedef struct PRELINKED {
+  const struct IREP *top_irep;		//!< IREP tree top.
+  const char * const *symbols;		//!< symbol names in order of ID.
+  uint16_t n_symbols;			//!< num of symbols.
+  int16_t sym_id_base;			//!< symbol ID of symbols[0].
+} mrbc_prelinked;
+
+
 /***** Global variables *****************************************************/
 /***** Function prototypes **************************************************/
 int mrbc_load_mrb(struct VM *vm, const void *bytecode);
 int mrbc_load_irep(struct VM *vm, const void *bytecode);
+int mrbc_prelink_symbols(const mrbc_prelinked *prelinked);
+int mrbc_load_prelinked(struct VM *vm, const mrbc_prelinked *prelinked);
 void mrbc_irep_free(struct IREP *irep);
+void mrbc_irep_clear_cache(const struct IREP *irep);
+struct IREP *mrbc_load_child_irep(struct VM *vm, const struct IREP *irep, int n);
+int mrbc_irep_evict(struct VM *vm);
+const void *mrbc_compressed_irep_block(const void *bytecode, int n, int *rom_size, int *ram_size);
+int mrbc_inflate_irep_block(const void *block, uint8_t *buf);
 mrbc_value mrbc_irep_pool_value(struct VM *vm, int n);
 
 /***** Inline functions *****************************************************/
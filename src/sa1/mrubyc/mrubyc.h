@@ -31,6 +31,7 @@
 #include "c_numeric.h"
 #include "c_range.h"
 #include "c_string.h"
+#include "c_packed_array.h"
 
 #include "load.h"
 #include "console.h"
@@ -227,6 +227,27 @@ enum OPCODE {
   OP_EXT2       = 0x67, //!< Z    make 2nd operand (b) 16bit
   OP_EXT3       = 0x68, //!< Z    make 1st and 2nd operands 16bit
   OP_STOP       = 0x69, //!< Z    stop VM
+
+/*-----------------------------------------------------------------------
+  superinstructions (VM internal, see MRBC_USE_SUPERINSTRUCTIONS)
+
+  The loader writes these over the first opcode of a sequence and
+  leaves the rest of the bytes as they are, so the operands are
+  read from the original instructions and jump targets don't move.
+------------------------------------------------------------------------*/
+  OP_EQ_JMPIF   = 0xE0, //!< B    OP_EQ R[a]; OP_JMPIF R[a]
+  OP_EQ_JMPNOT  = 0xE1, //!< B    OP_EQ R[a]; OP_JMPNOT R[a]
+  OP_LT_JMPIF   = 0xE2, //!< B    OP_LT R[a]; OP_JMPIF R[a]
+  OP_LT_JMPNOT  = 0xE3, //!< B    OP_LT R[a]; OP_JMPNOT R[a]
+  OP_LE_JMPIF   = 0xE4, //!< B    OP_LE R[a]; OP_JMPIF R[a]
+  OP_LE_JMPNOT  = 0xE5, //!< B    OP_LE R[a]; OP_JMPNOT R[a]
+  OP_GT_JMPIF   = 0xE6, //!< B    OP_GT R[a]; OP_JMPIF R[a]
+  OP_GT_JMPNOT  = 0xE7, //!< B    OP_GT R[a]; OP_JMPNOT R[a]
+  OP_GE_JMPIF   = 0xE8, //!< B    OP_GE R[a]; OP_JMPIF R[a]
+  OP_GE_JMPNOT  = 0xE9, //!< B    OP_GE R[a]; OP_JMPNOT R[a]
+  OP_LOADI16_ADD = 0xEA, //!< BS   OP_LOADI16 R[a+1]; OP_ADD R[a]
+  OP_GETIV_ADDI_SETIV = 0xEB, //!< BB   OP_GETIV R[a]; OP_ADDI R[a]; OP_SETIV R[a]
+  OP_MOVE_SEND  = 0xEC, //!< BB   OP_MOVE; OP_SEND
 };
 
 
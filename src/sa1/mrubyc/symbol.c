@@ -24,6 +24,7 @@
 /***** Local headers ********************************************************/
 #define MRBC_DEFINE_SYMBOL_TABLE
 #include "_autogen_builtin_symbol.h"
+#include "_autogen_builtin_symbol_hash.h"
 #undef MRBC_DEFINE_SYMBOL_TABLE
 #include "alloc.h"
 #include "value.h"
@@ -33,35 +34,52 @@
 #include "console.h"
 
 /***** Constant values ******************************************************/
-#if !defined(MRBC_SYMBOL_SEARCH_LINER) && !defined(MRBC_SYMBOL_SEARCH_BTREE)
-#define MRBC_SYMBOL_SEARCH_BTREE
+#if !defined(MRBC_SYMBOL_SEARCH_LINER) && !defined(MRBC_SYMBOL_SEARCH_HASH)
+#define MRBC_SYMBOL_SEARCH_HASH
 #endif
 
-#if MAX_SYMBOLS_COUNT <= UCHAR_MAX
-#define MRBC_SYMBOL_TABLE_INDEX_TYPE	uint8_t
-#else
-#define MRBC_SYMBOL_TABLE_INDEX_TYPE	uint16_t
+#define OFFSET_BUILTIN_SYMBOL 256
+
+#if MAX_SYMBOLS_COUNT > INT16_MAX - OFFSET_BUILTIN_SYMBOL
+#error "MAX_SYMBOLS_COUNT is too large for mrbc_sym."
 #endif
 
-#define OFFSET_BUILTIN_SYMBOL 256
+#define SYM_INDEX_CHUNK_BITS 5		// 32 symbols per chunk.
+#define SYM_INDEX_CHUNK_SIZE (1 << SYM_INDEX_CHUNK_BITS)
+#define SYM_HASH_INIT_SIZE 64		// power of 2.
 
 
 /***** Macros ***************************************************************/
+//! get n'th sym_index entry.
+#define sym_index_entry(n) \
+  ( &sym_index[(n) >> SYM_INDEX_CHUNK_BITS][(n) & (SYM_INDEX_CHUNK_SIZE - 1)] )
+
+
 /***** Typedefs *************************************************************/
 struct SYM_INDEX {
   uint16_t hash;	//!< hash value, returned by calc_hash().
-#ifdef MRBC_SYMBOL_SEARCH_BTREE
-  MRBC_SYMBOL_TABLE_INDEX_TYPE left;
-  MRBC_SYMBOL_TABLE_INDEX_TYPE right;
-#endif
   const char *cstr;	//!< point to the symbol string.
 };
 
+//! symbol string created by mrbc_symbol_new(), followed by the string.
+struct SYM_NAME {
+  struct SYM_NAME *next;	//!< next created symbol string.
+};
+
 
 /***** Function prototypes **************************************************/
 /***** Local variables ******************************************************/
-static struct SYM_INDEX sym_index[MAX_SYMBOLS_COUNT];
-static int sym_index_pos;	// point to the last(free) sym_index array.
+//! chunks of SYM_INDEX, allocated as symbols are added.
+static struct SYM_INDEX **sym_index;
+static int sym_index_chunks;	// size of sym_index array.
+static int sym_index_pos;	// point to the last(free) sym_index entry.
+#ifdef MRBC_SYMBOL_SEARCH_HASH
+//! open addressing hash table. sym_index entry index + 1, or 0 if empty.
+static uint16_t *sym_hash;
+static int sym_hash_size;	// power of 2, more than twice sym_index_pos.
+#endif
+//! list of symbol strings created by mrbc_symbol_new().
+static struct SYM_NAME *sym_names;
 
 
 /***** Global variables *****************************************************/
@@ -71,6 +89,9 @@ static int sym_index_pos;	// point to the last(free) sym_index array.
 //================================================================
 /*! Calculate hash value.
 
+  (note) make_symbol_hash.rb uses the same function to make
+  the perfect hash of built-in symbols.
+
   @param  str		Target string.
   @return uint16_t	Hash value.
 */
@@ -88,38 +109,18 @@ static inline uint16_t calc_hash(const char *str)
 //================================================================
 /*! search built-in symbol table
 
+  @param  hash	hash value.
   @param  str	string ptr.
   @return	symbol id. or -1 if not found.
 */
-static int search_builtin_symbol( const char *str )
+static int search_builtin_symbol( uint16_t hash, const char *str )
 {
-  int left = 0;
-  int right = sizeof(builtin_symbols) / sizeof(builtin_symbols[0]);
-
-  while( left < right ) {
-    int mid = (left + right) / 2;
-    const unsigned char *p1 = (const unsigned char *)builtin_symbols[mid];
-    const unsigned char *p2 = (const unsigned char *)str;
-
-    while( 1 ) {	// string compare, same order as cruby.
-      if( *p1 < *p2 ) {
-	left = mid + 1;
-	break;
-      }
-      if( *p1 > *p2 ) {
-	right = mid;
-	break;
-      }
-      if( *p1 == 0 ) {
-	return mid;
-      }
-
-      p1++;
-      p2++;
-    }
-  }
+  // minimal perfect hash. (see _autogen_builtin_symbol_hash.h)
+  uint16_t d = builtin_symbol_hash_disp[ hash & (MRBC_BUILTIN_SYMBOL_HASH_DISP_SIZE - 1) ];
+  int id = builtin_symbol_hash_id[ (uint16_t)(hash ^ d) % MRBC_BUILTIN_SYMBOL_HASH_SIZE ];
 
-  return -1;
+  if( strcmp( builtin_symbols[id], str ) != 0 ) return -1;
+  return id;
 }
 
 
@@ -135,30 +136,63 @@ static int search_index( uint16_t hash, const char *str )
 #ifdef MRBC_SYMBOL_SEARCH_LINER
   int i;
   for( i = 0; i < sym_index_pos; i++ ) {
-    if( sym_index[i].hash == hash && strcmp(str, sym_index[i].cstr) == 0 ) {
+    const struct SYM_INDEX *e = sym_index_entry(i);
+    if( e->hash == hash && strcmp(str, e->cstr) == 0 ) {
       return i;
     }
   }
   return -1;
 #endif
 
-#ifdef MRBC_SYMBOL_SEARCH_BTREE
-  int i = 0;
-  do {
-    if( sym_index[i].hash == hash && strcmp(str, sym_index[i].cstr) == 0 ) {
-      return i;
-    }
-    if( hash < sym_index[i].hash ) {
-      i = sym_index[i].left;
-    } else {
-      i = sym_index[i].right;
+#ifdef MRBC_SYMBOL_SEARCH_HASH
+  if( sym_hash_size == 0 ) return -1;
+
+  int i = hash & (sym_hash_size - 1);
+  int idx;
+  while( (idx = sym_hash[i]) != 0 ) {
+    idx--;
+    const struct SYM_INDEX *e = sym_index_entry(idx);
+    if( e->hash == hash && strcmp(str, e->cstr) == 0 ) {
+      return idx;
     }
-  } while( i != 0 );
+    i = (i + 1) & (sym_hash_size - 1);
+  }
   return -1;
 #endif
 }
 
 
+#ifdef MRBC_SYMBOL_SEARCH_HASH
+//================================================================
+/*! resize hash table and rehash all symbols.
+
+  @param  size	new size. (power of 2)
+  @return	0 if no error.
+*/
+static int resize_hash( int size )
+{
+  uint16_t *tbl = mrbc_raw_alloc( sizeof(uint16_t) * size );
+  if( !tbl ) return -1;		// ENOMEM
+  memset( tbl, 0, sizeof(uint16_t) * size );
+
+  int idx;
+  for( idx = 0; idx < sym_index_pos; idx++ ) {
+    int i = sym_index_entry(idx)->hash & (size - 1);
+    while( tbl[i] != 0 ) {
+      i = (i + 1) & (size - 1);
+    }
+    tbl[i] = idx + 1;
+  }
+
+  if( sym_hash ) mrbc_raw_free( sym_hash );
+  sym_hash = tbl;
+  sym_hash_size = size;
+
+  return 0;
+}
+#endif
+
+
 //================================================================
 /*! add to index table
 
@@ -170,32 +204,51 @@ static int add_index( uint16_t hash, const char *str )
 {
   if( sym_index_pos >= MAX_SYMBOLS_COUNT ) return -1;	// check overflow.
 
-  int idx = sym_index_pos++;
+  int idx = sym_index_pos;
+  int n_chunk = idx >> SYM_INDEX_CHUNK_BITS;
 
-  // append table.
-  sym_index[idx].hash = hash;
-  sym_index[idx].cstr = str;
-
-#ifdef MRBC_SYMBOL_SEARCH_BTREE
-  int i = 0;
-
-  while( 1 ) {
-    if( hash < sym_index[i].hash ) {
-      // left side
-      if( sym_index[i].left == 0 ) {	// left is empty?
-        sym_index[i].left = idx;
-        break;
-      }
-      i = sym_index[i].left;
-    } else {
-      // right side
-      if( sym_index[i].right == 0 ) {	// right is empty?
-        sym_index[i].right = idx;
-        break;
+#ifdef MRBC_SYMBOL_SEARCH_HASH
+  // keep the load factor of hash table 1/2 or less.
+  if( (idx + 1) * 2 > sym_hash_size ) {
+    if( resize_hash( sym_hash_size ? sym_hash_size * 2 : SYM_HASH_INIT_SIZE ) != 0 ) {
+      return -1;	// ENOMEM
+    }
+  }
+#endif
+
+  // need new chunk?
+  if( (idx & (SYM_INDEX_CHUNK_SIZE - 1)) == 0 ) {
+    if( n_chunk >= sym_index_chunks ) {
+      int size = sym_index_chunks ? sym_index_chunks * 2 : 4;
+      struct SYM_INDEX **p;
+      if( sym_index ) {
+	p = mrbc_raw_realloc( sym_index, sizeof(struct SYM_INDEX *) * size );
+      } else {
+	p = mrbc_raw_alloc( sizeof(struct SYM_INDEX *) * size );
       }
-      i = sym_index[i].right;
+      if( !p ) return -1;	// ENOMEM
+      sym_index = p;
+      sym_index_chunks = size;
     }
+
+    // symbols are never removed, so the chunk is freed only at cleanup.
+    sym_index[n_chunk] =
+      mrbc_raw_alloc_no_free( sizeof(struct SYM_INDEX) * SYM_INDEX_CHUNK_SIZE );
+    if( !sym_index[n_chunk] ) return -1;	// ENOMEM
   }
+
+  // append table.
+  struct SYM_INDEX *e = sym_index_entry(idx);
+  e->hash = hash;
+  e->cstr = str;
+  sym_index_pos++;
+
+#ifdef MRBC_SYMBOL_SEARCH_HASH
+  int i = hash & (sym_hash_size - 1);
+  while( sym_hash[i] != 0 ) {
+    i = (i + 1) & (sym_hash_size - 1);
+  }
+  sym_hash[i] = idx + 1;
 #endif
 
   return idx;
@@ -206,11 +259,34 @@ static int add_index( uint16_t hash, const char *str )
 
 //================================================================
 /*! cleanup
+
+  Frees the symbol table and the symbol strings created by
+  mrbc_symbol_new(). Call it before mrbc_cleanup_alloc(), because
+  MRBC_ALLOC_LIBC has no memory pool to reset.
 */
 void mrbc_cleanup_symbol(void)
 {
-  memset(sym_index, 0, sizeof(sym_index));
+  int i;
+  for( i = 0; i < sym_index_chunks; i++ ) {
+    if( (i << SYM_INDEX_CHUNK_BITS) >= sym_index_pos ) break;
+    mrbc_raw_free( sym_index[i] );
+  }
+  mrbc_raw_free( sym_index );
+  sym_index = NULL;
+  sym_index_chunks = 0;
   sym_index_pos = 0;
+
+  while( sym_names ) {
+    struct SYM_NAME *next = sym_names->next;
+    mrbc_raw_free( sym_names );
+    sym_names = next;
+  }
+
+#ifdef MRBC_SYMBOL_SEARCH_HASH
+  mrbc_raw_free( sym_hash );
+  sym_hash = NULL;
+  sym_hash_size = 0;
+#endif
 }
 
 
@@ -222,10 +298,10 @@ void mrbc_cleanup_symbol(void)
 */
 mrbc_sym mrbc_str_to_symid(const char *str)
 {
-  mrbc_sym sym_id = search_builtin_symbol(str);
+  uint16_t h = calc_hash(str);
+  mrbc_sym sym_id = search_builtin_symbol(h, str);
   if( sym_id >= 0 ) return sym_id;
 
-  uint16_t h = calc_hash(str);
   sym_id = search_index(h, str);
   if( sym_id < 0 ) sym_id = add_index( h, str );
   if( sym_id < 0 ) return sym_id;
@@ -251,7 +327,7 @@ const char * mrbc_symid_to_str(mrbc_sym sym_id)
   if( sym_id < 0 ) return NULL;
   if( sym_id >= sym_index_pos ) return NULL;
 
-  return sym_index[sym_id].cstr;
+  return sym_index_entry(sym_id)->cstr;
 }
 
 
@@ -263,10 +339,10 @@ const char * mrbc_symid_to_str(mrbc_sym sym_id)
 */
 mrbc_sym mrbc_search_symid( const char *str )
 {
-  mrbc_sym sym_id = search_builtin_symbol(str);
+  uint16_t h = calc_hash(str);
+  mrbc_sym sym_id = search_builtin_symbol(h, str);
   if( sym_id >= 0 ) return sym_id;
 
-  uint16_t h = calc_hash(str);
   sym_id = search_index(h, str);
   if( sym_id < 0 ) return sym_id;
 
@@ -274,6 +350,29 @@ mrbc_sym mrbc_search_symid( const char *str )
 }
 
 
+//================================================================
+/*! Register the symbols without search.
+
+  The symbol IDs of the pre-linked IREP are fixed at build time,
+  so the names are registered in that order. (see load.c)
+
+  @param  names	array of symbol strings. (not built-in symbols)
+  @param  n	num of symbols.
+  @return	symbol id of the first name. or -1 if error.
+*/
+mrbc_sym mrbc_add_symbols( const char * const names[], int n )
+{
+  int first = sym_index_pos;
+  int i;
+
+  for( i = 0; i < n; i++ ) {
+    if( add_index( calc_hash(names[i]), names[i] ) < 0 ) return -1;
+  }
+
+  return first + OFFSET_BUILTIN_SYMBOL;
+}
+
+
 //================================================================
 /*! constructor
 
@@ -288,16 +387,21 @@ mrbc_value mrbc_symbol_new(struct VM *vm, const char *str)
 
   // create symbol object dynamically.
   int size = strlen(str) + 1;
-  char *buf = mrbc_raw_alloc_no_free(size);
-  if( buf == NULL ) return mrbc_nil_value();	// ENOMEM raise?
+  struct SYM_NAME *name =
+    mrbc_raw_alloc_no_free( sizeof(struct SYM_NAME) + size );
+  if( name == NULL ) return mrbc_nil_value();	// ENOMEM raise?
 
+  char *buf = (char *)(name + 1);
   memcpy(buf, str, size);
   sym_id = add_index( calc_hash(buf), buf );
   if( sym_id < 0 ) {
+    mrbc_raw_free( name );
     mrbc_raisef(vm, MRBC_CLASS(Exception),
 		"Overflow MAX_SYMBOLS_COUNT for '%s'", str );
     return mrbc_nil_value();
   }
+  name->next = sym_names;
+  sym_names = name;
 
   sym_id += OFFSET_BUILTIN_SYMBOL;
 
@@ -382,7 +486,7 @@ void mrbc_debug_dump_symbol(void)
   int i;
   for( i = 0; i < sym_index_pos; i++ ) {
     mrbc_sym sym_id = i + OFFSET_BUILTIN_SYMBOL;
-    mrbc_printf(" %04x:%s\n", sym_id, sym_index[i].cstr );
+    mrbc_printf(" %04x:%s\n", sym_id, sym_index_entry(i)->cstr );
   }
 
   mrbc_print("\n");
@@ -32,6 +32,7 @@ void mrbc_cleanup_symbol(void);
 mrbc_sym mrbc_str_to_symid(const char *str);
 const char *mrbc_symid_to_str(mrbc_sym sym_id);
 mrbc_sym mrbc_search_symid(const char *str);
+mrbc_sym mrbc_add_symbols(const char * const names[], int n);
 mrbc_value mrbc_symbol_new(struct VM *vm, const char *str);
 void mrbc_debug_dump_symbol(void);
 void mrbc_symbol_statistics(int *total_used);
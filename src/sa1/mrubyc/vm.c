@@ -28,10 +28,12 @@
 #include "symbol.h"
 #include "class.h"
 #include "error.h"
+#include "c_numeric.h"
 #include "c_string.h"
 #include "c_range.h"
 #include "c_array.h"
 #include "c_hash.h"
+#include "c_packed_array.h"
 #include "global.h"
 #include "load.h"
 #include "console.h"
@@ -50,10 +52,80 @@
 //! for getting the VM ID
 static uint16_t free_vm_bitmap[MAX_VM_COUNT / 16 + 1];
 
+//! opened VMs, indexed by vm_id - 1. (for clearing the inline caches)
+static mrbc_vm *opened_vm[MAX_VM_COUNT];
+
+#if defined(MRBC_PROFILE_OPCODES)
+//! executed count of each opcode.
+static uint32_t opcode_count[256];
+
+//! executed count of opcode pairs. (open addressing hash table)
+static mrbc_opcode_pair_count opcode_pair_count[MRBC_OPCODE_PAIR_TABLE_SIZE];
+
+//! previous executed opcode.
+static uint8_t last_opcode;
+static uint32_t opcode_pair_dropped;	//!< pairs not counted, as the table is full.
+
+//! opcode names for the profile report.
+static const char * const opcode_names[] = {
+  "NOP", "MOVE", "LOADL", "LOADI", "LOADINEG", "LOADI__1", "LOADI_0",
+  "LOADI_1", "LOADI_2", "LOADI_3", "LOADI_4", "LOADI_5", "LOADI_6",
+  "LOADI_7", "LOADI16", "LOADI32", "LOADSYM", "LOADNIL", "LOADSELF",
+  "LOADT", "LOADF", "GETGV", "SETGV", "GETSV", "SETSV", "GETIV", "SETIV",
+  "GETCV", "SETCV", "GETCONST", "SETCONST", "GETMCNST", "SETMCNST",
+  "GETUPVAR", "SETUPVAR", "GETIDX", "SETIDX", "JMP", "JMPIF", "JMPNOT",
+  "JMPNIL", "JMPUW", "EXCEPT", "RESCUE", "RAISEIF", "SSEND", "SSENDB",
+  "SEND", "SENDB", "CALL", "SUPER", "ARGARY", "ENTER", "KEY_P", "KEYEND",
+  "KARG", "RETURN", "RETURN_BLK", "BREAK", "BLKPUSH", "ADD", "ADDI", "SUB",
+  "SUBI", "MUL", "DIV", "EQ", "LT", "LE", "GT", "GE", "ARRAY", "ARRAY2",
+  "ARYCAT", "ARYPUSH", "ARYDUP", "AREF", "ASET", "APOST", "INTERN",
+  "SYMBOL", "STRING", "STRCAT", "HASH", "HASHADD", "HASHCAT", "LAMBDA",
+  "BLOCK", "METHOD", "RANGE_INC", "RANGE_EXC", "OCLASS", "CLASS", "MODULE",
+  "EXEC", "DEF", "ALIAS", "UNDEF", "SCLASS", "TCLASS", "DEBUG", "ERR",
+  "EXT1", "EXT2", "EXT3", "STOP",
+};
+
+//! superinstruction names. (OP_EQ_JMPIF...)
+static const char * const super_opcode_names[] = {
+  "EQ_JMPIF", "EQ_JMPNOT", "LT_JMPIF", "LT_JMPNOT", "LE_JMPIF", "LE_JMPNOT",
+  "GT_JMPIF", "GT_JMPNOT", "GE_JMPIF", "GE_JMPNOT", "LOADI16_ADD",
+  "GETIV_ADDI_SETIV", "MOVE_SEND",
+};
+#endif
+
 
 /***** Global variables *****************************************************/
 /***** Signal catching functions ********************************************/
 /***** Local functions ******************************************************/
+//================================================================
+/*! Find method using the inline method cache.
+
+  @param  r_method	pointer to mrbc_method to return values.
+  @param  cls		search class.
+  @param  sym_id	symbol id.
+  @param  cache		pointer to cache entry of the call site, or NULL.
+  @return		pointer to method or NULL.
+*/
+static inline mrbc_method * find_method_by_cache( mrbc_method *r_method, mrbc_class *cls, mrbc_sym sym_id, mrbc_irep_cache *cache )
+{
+  if( !cache ) return mrbc_find_method( r_method, cls, sym_id );
+
+  if( cache->cls == cls &&
+      cache->generation == mrbc_method_cache_generation ) {
+    *r_method = cache->method;
+    return r_method;
+  }
+
+  if( mrbc_find_method( r_method, cls, sym_id ) == 0 ) return 0;
+
+  cache->cls = cls;
+  cache->generation = mrbc_method_cache_generation;
+  cache->method = *r_method;
+
+  return r_method;
+}
+
+
 //================================================================
 /*! Method call by method name's id
 
@@ -61,9 +133,10 @@ static uint16_t free_vm_bitmap[MAX_VM_COUNT / 16 + 1];
   @param  sym_id	method name symbol id
   @param  a		operand a
   @param  c		bit: 0-3=narg, 4-7=karg, 8=have block param flag.
+  @param  cache		inline method cache of the call site, or NULL.
   @retval 0  No error.
 */
-static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c )
+static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c, mrbc_irep_cache *cache )
 {
   int narg = c & 0x0f;
   int karg = (c >> 4) & 0x0f;
@@ -111,7 +184,7 @@ static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c )
 
   mrbc_class *cls = find_class_by_object(recv);
   mrbc_method method;
-  if( mrbc_find_method( &method, cls, sym_id ) == 0 ) {
+  if( find_method_by_cache( &method, cls, sym_id, cache ) == 0 ) {
     mrbc_raisef(vm, MRBC_CLASS(NoMethodError),
 		"undefined local variable or method '%s' for %s",
 		mrbc_symid_to_str(sym_id), mrbc_symid_to_str( cls->sym_id ));
@@ -119,10 +192,22 @@ static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c )
   }
 
   if( method.c_func ) {
-    // call C method.
-    method.func(vm, recv, narg);
-    if( sym_id == MRBC_SYM(call) ) return;
-    if( sym_id == MRBC_SYM(new) ) return;
+    if( method.c_func == 3 && recv->tt == MRBC_TT_OBJECT ) {
+      // attr_reader. read the instance variable directly.
+      mrbc_value ret = mrbc_instance_getiv(recv, method.ivar_id);
+      mrbc_decref(recv);
+      *recv = ret;
+
+    } else if( method.c_func == 4 && recv->tt == MRBC_TT_OBJECT && narg == 1 ) {
+      // attr_writer.
+      mrbc_instance_setiv(recv, method.ivar_id, recv + 1);
+
+    } else {
+      // call C method.
+      method.func(vm, recv, narg);
+      if( sym_id == MRBC_SYM(call) ) return;
+      if( sym_id == MRBC_SYM(new) ) return;
+    }
 
     int i;
     for( i = 1; i <= narg+1; i++ ) {
@@ -132,6 +217,7 @@ static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c )
   } else {
     // call Ruby method.
     mrbc_callinfo *callinfo = mrbc_push_callinfo(vm, sym_id, a, narg);
+    if( !callinfo ) return;
     callinfo->own_class = method.cls;
 
     vm->cur_irep = method.irep;
@@ -141,6 +227,23 @@ static void send_by_name( struct VM *vm, mrbc_sym sym_id, int a, int c )
 }
 
 
+//================================================================
+/*! get the n'th child irep of current irep.
+
+  @param  vm	pointer to VM.
+  @param  n	n'th child.
+  @return	pointer to irep, or NULL if error. (exception raised)
+*/
+static inline mrbc_irep *child_irep( struct VM *vm, int n )
+{
+  mrbc_irep *irep = mrbc_irep_child_irep(vm->cur_irep, n);
+#if defined(MRBC_USE_LAZY_IREP)
+  if( !irep ) irep = mrbc_load_child_irep(vm, vm->cur_irep, n);
+#endif
+  return irep;
+}
+
+
 //================================================================
 /*! Find ensure catch handler
 */
@@ -196,6 +299,23 @@ static mrbc_value * mrbc_get_self( struct VM *vm, mrbc_value *regs )
 void mrbc_cleanup_vm(void)
 {
   memset(free_vm_bitmap, 0, sizeof(free_vm_bitmap));
+  memset(opened_vm, 0, sizeof(opened_vm));
+}
+
+
+//================================================================
+/*! clear the inline caches of all opened VMs.
+
+  Called when a cache generation wraps around, so that no entry
+  cached before the wrap can become valid again.
+*/
+void mrbc_clear_all_inline_cache(void)
+{
+  int i;
+  for( i = 0; i < MAX_VM_COUNT; i++ ) {
+    mrbc_vm *vm = opened_vm[i];
+    if( vm && vm->top_irep ) mrbc_irep_clear_cache( vm->top_irep );
+  }
 }
 
 
@@ -234,8 +354,12 @@ const char *mrbc_get_callee_name( struct VM *vm )
 */
 mrbc_callinfo * mrbc_push_callinfo( struct VM *vm, mrbc_sym method_id, int reg_offset, int n_args )
 {
-  mrbc_callinfo *callinfo = mrbc_alloc(vm, sizeof(mrbc_callinfo));
-  if( !callinfo ) return callinfo;
+  mrbc_callinfo *callinfo = vm->callinfo_tail ?
+			vm->callinfo_tail + 1 : vm->callinfo_stack;
+  if( callinfo >= vm->callinfo_end ) {
+    mrbc_raise(vm, MRBC_CLASS(SystemStackError), "stack level too deep");
+    return NULL;
+  }
 
   callinfo->cur_irep = vm->cur_irep;
   callinfo->inst = vm->inst;
@@ -277,8 +401,6 @@ void mrbc_pop_callinfo( struct VM *vm )
   vm->cur_regs = callinfo->cur_regs;
   vm->target_class = callinfo->target_class;
   vm->callinfo_tail = callinfo->prev;
-
-  mrbc_free(vm, callinfo);
 }
 
 
@@ -303,7 +425,8 @@ void mrbc_pop_callinfo( struct VM *vm )
 */
 mrbc_vm * mrbc_vm_new( int regs_size )
 {
-  mrbc_vm *vm = mrbc_raw_alloc(sizeof(mrbc_vm) + sizeof(mrbc_value) * regs_size);
+  mrbc_vm *vm = mrbc_raw_alloc(sizeof(mrbc_vm) + sizeof(mrbc_value) * regs_size
+			       + sizeof(mrbc_callinfo) * MAX_CALLINFO_SIZE);
   if( !vm ) return NULL;
 
   memset(vm, 0, sizeof(mrbc_vm));	// caution: assume NULL is zero.
@@ -313,6 +436,10 @@ mrbc_vm * mrbc_vm_new( int regs_size )
   vm->flag_need_memfree = 1;
   vm->regs_size = regs_size;
 
+  // callinfo stack follows the registers.
+  vm->callinfo_stack = (mrbc_callinfo *)(vm->regs + regs_size);
+  vm->callinfo_end = vm->callinfo_stack + MAX_CALLINFO_SIZE;
+
   return vm;
 }
 
@@ -344,6 +471,7 @@ mrbc_vm * mrbc_vm_open( struct VM *vm )
     return NULL;
   }
 
+  opened_vm[vm_id] = vm;
   vm->vm_id = ++vm_id;
 
   return vm;
@@ -361,9 +489,11 @@ void mrbc_vm_close( struct VM *vm )
   int idx = (vm->vm_id-1) >> 4;
   int bit = 1 << ((vm->vm_id-1) & 0x0f);
   free_vm_bitmap[idx] &= ~bit;
+  opened_vm[vm->vm_id-1] = NULL;
 
   // free irep and vm
-  if( vm->top_irep ) mrbc_irep_free( vm->top_irep );
+  if( vm->top_irep && !vm->flag_prelinked ) mrbc_irep_free( vm->top_irep );
+  mrbc_clear_method_cache();	// caches may refer to the freed methods.
   if( vm->flag_need_memfree ) mrbc_raw_free(vm);
 }
 
@@ -432,6 +562,115 @@ void mrbc_vm_end( struct VM *vm )
 }
 
 
+#if defined(MRBC_PROFILE_OPCODES)
+//================================================================
+/*! Count an executed opcode. (called by mrbc_vm_run)
+
+  @param  op	opcode.
+*/
+void mrbc_profile_opcode( int op )
+{
+  opcode_count[op]++;
+
+  // count the pair with the previous opcode.
+  uint16_t ops = (uint16_t)last_opcode << 8 | op;
+  int idx = (ops * 31) & (MRBC_OPCODE_PAIR_TABLE_SIZE - 1);
+  int i;
+  for( i = 0; i < MRBC_OPCODE_PAIR_TABLE_SIZE; i++ ) {
+    mrbc_opcode_pair_count *pair = &opcode_pair_count[idx];
+    if( pair->count == 0 ) pair->ops = ops;
+    if( pair->ops == ops ) {
+      pair->count++;
+      break;
+    }
+    idx = (idx + 1) & (MRBC_OPCODE_PAIR_TABLE_SIZE - 1);
+  }
+  if( i == MRBC_OPCODE_PAIR_TABLE_SIZE ) opcode_pair_dropped++;
+
+  last_opcode = op;
+}
+
+
+//================================================================
+/*! Clear the opcode profile.
+*/
+void mrbc_clear_opcode_profile( void )
+{
+  memset( opcode_count, 0, sizeof(opcode_count) );
+  memset( opcode_pair_count, 0, sizeof(opcode_pair_count) );
+  last_opcode = 0;
+  opcode_pair_dropped = 0;
+}
+
+
+//================================================================
+/*! Get the number of opcode pairs not counted, because the pair table
+  was full. If not 0, the pair profile misses some pairs and
+  MRBC_OPCODE_PAIR_TABLE_SIZE should be enlarged.
+*/
+uint32_t mrbc_get_opcode_pair_dropped( void )
+{
+  return opcode_pair_dropped;
+}
+
+
+//================================================================
+/*! Get the most executed opcodes or opcode pairs.
+
+  @param  flag_pair	get opcode pairs if true.
+  @param  n		max number of entries.
+  @param  ops		returns opcodes. ((previous << 8) | opcode if pair)
+  @param  counts	returns executed counts.
+  @return		number of entries. (in descending order of count)
+*/
+int mrbc_get_opcode_profile( int flag_pair, int n, uint16_t ops[], uint32_t counts[] )
+{
+  int size = flag_pair ? MRBC_OPCODE_PAIR_TABLE_SIZE : 256;
+  int i, j;
+
+  for( i = 0; i < n; i++ ) {
+    uint32_t max_count = 0;
+    uint16_t max_ops = 0;
+
+    for( j = 0; j < size; j++ ) {
+      uint16_t op = flag_pair ? opcode_pair_count[j].ops : j;
+      uint32_t count = flag_pair ? opcode_pair_count[j].count : opcode_count[j];
+
+      // next to the previous entry.
+      if( i > 0 && (count > counts[i-1] ||
+		    (count == counts[i-1] && op <= ops[i-1])) ) continue;
+      if( count > max_count || (count == max_count && op < max_ops) ) {
+	max_count = count;
+	max_ops = op;
+      }
+    }
+
+    if( max_count == 0 ) break;
+    ops[i] = max_ops;
+    counts[i] = max_count;
+  }
+
+  return i;
+}
+
+
+//================================================================
+/*! Get the opcode name.
+
+  @param  op	opcode.
+  @return	name of opcode, or "?" if unknown.
+*/
+const char *mrbc_opcode_name( int op )
+{
+  if( op <= OP_STOP ) return opcode_names[op];
+  if( op >= OP_EQ_JMPIF && op <= OP_MOVE_SEND ) {
+    return super_opcode_names[op - OP_EQ_JMPIF];
+  }
+  return "?";
+}
+#endif
+
+
 /***** opecode functions ****************************************************/
 #if defined(MRBC_SUPPORT_OP_EXT)
 #define EXT , int ext
@@ -667,16 +906,23 @@ static inline void op_getiv( mrbc_vm *vm, mrbc_value *regs EXT )
 {
   FETCH_BB();
 
-  const char *sym_name = mrbc_irep_symbol_cstr(vm->cur_irep, b);
-  mrbc_sym sym_id = mrbc_str_to_symid(sym_name+1);   // skip '@'
-  if( sym_id < 0 ) {
-    mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow MAX_SYMBOLS_COUNT");
-    return;
-  }
   mrbc_value *self = mrbc_get_self( vm, regs );
+  mrbc_irep_cache *cache = mrbc_irep_cache_entry(vm->cur_irep, b);
+  mrbc_instance *ins = self->instance;
 
   mrbc_decref(&regs[a]);
-  regs[a] = mrbc_instance_getiv(self, sym_id);
+  if( cache->shape != ins->shape ) {
+    int slot = mrbc_shape_find_slot( ins->shape, mrbc_irep_ivar_id(vm->cur_irep, b) );
+    if( slot < 0 ) {
+      mrbc_set_nil( &regs[a] );
+      return;
+    }
+    cache->shape = ins->shape;
+    cache->slot = slot;
+  }
+
+  regs[a] = ins->ivar[cache->slot];
+  mrbc_incref(&regs[a]);
 }
 
 
@@ -689,15 +935,25 @@ static inline void op_setiv( mrbc_vm *vm, mrbc_value *regs EXT )
 {
   FETCH_BB();
 
-  const char *sym_name = mrbc_irep_symbol_cstr(vm->cur_irep, b);
-  mrbc_sym sym_id = mrbc_str_to_symid(sym_name+1);   // skip '@'
-  if( sym_id < 0 ) {
-    mrbc_raise(vm, MRBC_CLASS(Exception), "Overflow MAX_SYMBOLS_COUNT");
+  mrbc_value *self = mrbc_get_self( vm, regs );
+  mrbc_irep_cache *cache = mrbc_irep_cache_entry(vm->cur_irep, b);
+  mrbc_instance *ins = self->instance;
+
+  if( cache->shape == ins->shape ) {
+    mrbc_incref(&regs[a]);
+    mrbc_decref(&ins->ivar[cache->slot]);
+    ins->ivar[cache->slot] = regs[a];
     return;
   }
-  mrbc_value *self = mrbc_get_self( vm, regs );
 
+  mrbc_sym sym_id = mrbc_irep_ivar_id(vm->cur_irep, b);
   mrbc_instance_setiv(self, sym_id, &regs[a]);
+
+  // cache the slot for the shape after the assignment.
+  int slot = mrbc_shape_find_slot( ins->shape, sym_id );
+  if( slot < 0 ) return;	// ENOMEM
+  cache->shape = ins->shape;
+  cache->slot = slot;
 }
 
 
@@ -711,19 +967,27 @@ static inline void op_getconst( mrbc_vm *vm, mrbc_value *regs EXT )
   FETCH_BB();
 
   mrbc_sym sym_id = mrbc_irep_symbol_id(vm->cur_irep, b);
-  mrbc_class *cls = NULL;
+  mrbc_irep_cache *cache = mrbc_irep_cache_entry(vm->cur_irep, b);
+  mrbc_class *scope = NULL;
   mrbc_value *v;
 
   if( vm->target_class->sym_id != MRBC_SYM(Object) ) {
-    cls = vm->target_class;
+    scope = vm->target_class;
   } else if( vm->callinfo_tail ) {
-    cls = vm->callinfo_tail->own_class;
+    scope = vm->callinfo_tail->own_class;
+  }
+
+  if( cache->cls == scope &&
+      cache->generation == mrbc_const_cache_generation ) {
+    v = cache->value;
+    goto DONE;
   }
 
   // search back through super classes.
+  mrbc_class *cls = scope;
   while( cls != NULL ) {
     v = mrbc_get_class_const(cls, sym_id);
-    if( v != NULL ) goto DONE;
+    if( v != NULL ) goto FOUND;
     cls = cls->super;
   }
 
@@ -735,6 +999,11 @@ static inline void op_getconst( mrbc_vm *vm, mrbc_value *regs EXT )
     return;
   }
 
+ FOUND:
+  cache->cls = scope;
+  cache->generation = mrbc_const_cache_generation;
+  cache->value = v;
+
  DONE:
   mrbc_incref(v);
   mrbc_decref(&regs[a]);
@@ -772,16 +1041,27 @@ static inline void op_getmcnst( mrbc_vm *vm, mrbc_value *regs EXT )
   FETCH_BB();
 
   mrbc_sym sym_id = mrbc_irep_symbol_id(vm->cur_irep, b);
+  mrbc_irep_cache *cache = mrbc_irep_cache_entry(vm->cur_irep, b);
   mrbc_class *cls = regs[a].cls;
   mrbc_value *v;
 
-  while( !(v = mrbc_get_class_const(cls, sym_id)) ) {
-    cls = cls->super;
-    if( !cls ) {
-      mrbc_raisef( vm, MRBC_CLASS(NameError), "uninitialized constant %s::%s",
-	mrbc_symid_to_str( regs[a].cls->sym_id ), mrbc_symid_to_str( sym_id ));
-      return;
+  if( cache->cls == cls &&
+      cache->generation == mrbc_const_cache_generation ) {
+    v = cache->value;
+
+  } else {
+    while( !(v = mrbc_get_class_const(cls, sym_id)) ) {
+      cls = cls->super;
+      if( !cls ) {
+	mrbc_raisef( vm, MRBC_CLASS(NameError), "uninitialized constant %s::%s",
+	  mrbc_symid_to_str( regs[a].cls->sym_id ), mrbc_symid_to_str( sym_id ));
+	return;
+      }
     }
+
+    cache->cls = regs[a].cls;
+    cache->generation = mrbc_const_cache_generation;
+    cache->value = v;
   }
 
   mrbc_incref(v);
@@ -869,7 +1149,28 @@ static inline void op_getidx( mrbc_vm *vm, mrbc_value *regs EXT )
 {
   FETCH_B();
 
-  send_by_name( vm, MRBC_SYMID_BL_BR, a, 1 );
+  mrbc_value *recv = &regs[a];
+  mrbc_value *idx = &regs[a+1];
+  mrbc_value val;
+  mrbc_packed_array *pa;
+
+  // fast path: Array[Integer], Hash[immediate] and packed array[Integer]
+  if( recv->tt == MRBC_TT_ARRAY && idx->tt == MRBC_TT_INTEGER ) {
+    val = mrbc_array_get( recv, mrbc_integer(*idx) );
+  } else if( recv->tt == MRBC_TT_HASH &&
+	     idx->tt <= MRBC_TT_INC_DEC_THRESHOLD ) {
+    val = mrbc_hash_get( recv, idx );
+  } else if( idx->tt == MRBC_TT_INTEGER && (pa = mrbc_to_packed_array(recv)) &&
+	     (mrbc_uint_t)mrbc_integer(*idx) < pa->size ) {
+    val = mrbc_integer_value( mrbc_packed_array_get(pa, mrbc_integer(*idx)) );
+  } else {
+    send_by_name( vm, MRBC_SYMID_BL_BR, a, 1, 0 );
+    return;
+  }
+
+  mrbc_incref(&val);
+  mrbc_decref(recv);
+  *recv = val;
 }
 
 
@@ -882,7 +1183,32 @@ static inline void op_setidx( mrbc_vm *vm, mrbc_value *regs EXT )
 {
   FETCH_B();
 
-  send_by_name( vm, MRBC_SYMID_BL_BR_EQ, a, 2 );
+  mrbc_value *recv = &regs[a];
+  mrbc_value *idx = &regs[a+1];
+  mrbc_packed_array *pa;
+
+  // fast path: Array[Integer] = val, Hash[immediate] = val
+  //  and packed array[Integer] = Integer, unless it is a view of ROM.
+  if( recv->tt == MRBC_TT_ARRAY && idx->tt == MRBC_TT_INTEGER ) {
+    if( mrbc_array_set( recv, mrbc_integer(*idx), &regs[a+2] ) != 0 ) {
+      mrbc_raise( vm, MRBC_CLASS(IndexError), "too small for array");
+      return;
+    }
+  } else if( recv->tt == MRBC_TT_HASH &&
+	     idx->tt <= MRBC_TT_INC_DEC_THRESHOLD ) {
+    if( mrbc_hash_set( recv, idx, &regs[a+2] ) != 0 ) return;	// ENOMEM
+  } else if( idx->tt == MRBC_TT_INTEGER && regs[a+2].tt == MRBC_TT_INTEGER &&
+	     (pa = mrbc_to_packed_array(recv)) &&
+	     (mrbc_uint_t)mrbc_integer(*idx) < pa->size &&
+	     !(pa->flags & MRBC_PACKED_ARRAY_ROM) ) {
+    mrbc_packed_array_set( pa, mrbc_integer(*idx), mrbc_integer(regs[a+2]) );
+  } else {
+    send_by_name( vm, MRBC_SYMID_BL_BR_EQ, a, 2, 0 );
+    return;
+  }
+
+  // the container owns the value now.
+  mrbc_set_nil( &regs[a+2] );
 }
 
 
@@ -1176,7 +1502,8 @@ static inline void op_ssend( mrbc_vm *vm, mrbc_value *regs EXT )
   regs[a] = *mrbc_get_self( vm, regs );
   mrbc_incref( &regs[a] );
 
-  send_by_name( vm, mrbc_irep_symbol_id(vm->cur_irep, b), a, c );
+  send_by_name( vm, mrbc_irep_symbol_id(vm->cur_irep, b), a, c,
+		mrbc_irep_cache_entry(vm->cur_irep, b) );
 }
 
 
@@ -1194,7 +1521,8 @@ static inline void op_ssendb( mrbc_vm *vm, mrbc_value *regs EXT )
   regs[a] = *mrbc_get_self( vm, regs );
   mrbc_incref( &regs[a] );
 
-  send_by_name( vm, mrbc_irep_symbol_id(vm->cur_irep, b), a, c | 0x100 );
+  send_by_name( vm, mrbc_irep_symbol_id(vm->cur_irep, b), a, c | 0x100,
+		mrbc_irep_cache_entry(vm->cur_irep, b) );
 }
 
 
@@ -1208,7 +1536,32 @@ static inline void op_send( mrbc_vm *vm, mrbc_value *regs EXT )
 {
   FETCH_BBB();
 
-  send_by_name( vm, mrbc_irep_symbol_id(vm->cur_irep, b), a, c );
+  // fast path: Integer binary operators without an opcode of their own.
+  if( c == 1 && regs[a].tt == MRBC_TT_INTEGER &&
+      regs[a+1].tt == MRBC_TT_INTEGER ) {
+    mrbc_int_t x = regs[a].i;
+    mrbc_int_t y = regs[a+1].i;
+
+    switch( mrbc_irep_symbol_id(vm->cur_irep, b) ) {
+    case MRBC_SYM(AND):   regs[a].i = x & y; return;
+    case MRBC_SYM(OR):    regs[a].i = x | y; return;
+    case MRBC_SYM(XOR):   regs[a].i = x ^ y; return;
+    case MRBC_SYM(LT_LT): regs[a].i = mrbc_integer_shift(x, y);  return;
+    case MRBC_SYM(GT_GT): regs[a].i = mrbc_integer_shift(x, -y); return;
+    case MRBC_SYM(MOD):
+      if( y == 0 ) {
+	mrbc_raise(vm, MRBC_CLASS(ZeroDivisionError), 0 );
+      } else {
+	regs[a].i = x % y;
+      }
+      return;
+    default:
+      break;
+    }
+  }
+
+  send_by_name( vm, mrbc_irep_symbol_id(vm->cur_irep, b), a, c,
+		mrbc_irep_cache_entry(vm->cur_irep, b) );
 }
 
 
@@ -1221,7 +1574,8 @@ static inline void op_sendb( mrbc_vm *vm, mrbc_value *regs EXT )
 {
   FETCH_BBB();
 
-  send_by_name( vm, mrbc_irep_symbol_id(vm->cur_irep, b), a, c | 0x100 );
+  send_by_name( vm, mrbc_irep_symbol_id(vm->cur_irep, b), a, c | 0x100,
+		mrbc_irep_cache_entry(vm->cur_irep, b) );
 }
 
 
@@ -1292,6 +1646,7 @@ static inline void op_super( mrbc_vm *vm, mrbc_value *regs EXT )
   }
 
   callinfo = mrbc_push_callinfo(vm, callinfo->method_id, a, b);
+  if( !callinfo ) return;
   callinfo->own_class = method.cls;
   callinfo->is_called_super = 1;
 
@@ -1813,7 +2168,7 @@ static inline void op_add( mrbc_vm *vm, mrbc_value *regs EXT )
   }
 
   // other case
-  send_by_name( vm, MRBC_SYM(PLUS), a, 1 );
+  send_by_name( vm, MRBC_SYM(PLUS), a, 1, 0 );
 }
 
 
@@ -1876,7 +2231,7 @@ static inline void op_sub( mrbc_vm *vm, mrbc_value *regs EXT )
   }
 
   // other case
-  send_by_name( vm, MRBC_SYM(MINUS), a, 1 );
+  send_by_name( vm, MRBC_SYM(MINUS), a, 1, 0 );
 }
 
 
@@ -1939,7 +2294,7 @@ static inline void op_mul( mrbc_vm *vm, mrbc_value *regs EXT )
   }
 
   // other case
-  send_by_name( vm, MRBC_SYM(MUL), a, 1 );
+  send_by_name( vm, MRBC_SYM(MUL), a, 1, 0 );
 }
 
 
@@ -1981,7 +2336,7 @@ static inline void op_div( mrbc_vm *vm, mrbc_value *regs EXT )
   }
 
   // other case
-  send_by_name( vm, MRBC_SYM(DIV), a, 1 );
+  send_by_name( vm, MRBC_SYM(DIV), a, 1, 0 );
 }
 
 
@@ -1995,7 +2350,7 @@ static inline void op_eq( mrbc_vm *vm, mrbc_value *regs EXT )
   FETCH_B();
 
   if (regs[a].tt == MRBC_TT_OBJECT) {
-    send_by_name(vm, MRBC_SYM(EQ_EQ), a, 1);
+    send_by_name(vm, MRBC_SYM(EQ_EQ), a, 1, 0);
     return;
   }
 
@@ -2016,7 +2371,7 @@ static inline void op_lt( mrbc_vm *vm, mrbc_value *regs EXT )
   FETCH_B();
 
   if (regs[a].tt == MRBC_TT_OBJECT) {
-    send_by_name(vm, MRBC_SYM(LT), a, 1);
+    send_by_name(vm, MRBC_SYM(LT), a, 1, 0);
     return;
   }
 
@@ -2037,7 +2392,7 @@ static inline void op_le( mrbc_vm *vm, mrbc_value *regs EXT )
   FETCH_B();
 
   if (regs[a].tt == MRBC_TT_OBJECT) {
-    send_by_name(vm, MRBC_SYM(LT_EQ), a, 1);
+    send_by_name(vm, MRBC_SYM(LT_EQ), a, 1, 0);
     return;
   }
 
@@ -2058,7 +2413,7 @@ static inline void op_gt( mrbc_vm *vm, mrbc_value *regs EXT )
   FETCH_B();
 
   if (regs[a].tt == MRBC_TT_OBJECT) {
-    send_by_name(vm, MRBC_SYM(GT), a, 1);
+    send_by_name(vm, MRBC_SYM(GT), a, 1, 0);
     return;
   }
 
@@ -2079,7 +2434,7 @@ static inline void op_ge( mrbc_vm *vm, mrbc_value *regs EXT )
   FETCH_B();
 
   if (regs[a].tt == MRBC_TT_OBJECT) {
-    send_by_name(vm, MRBC_SYM(GT_EQ), a, 1);
+    send_by_name(vm, MRBC_SYM(GT_EQ), a, 1, 0);
     return;
   }
 
@@ -2454,7 +2809,12 @@ static inline void op_method( mrbc_vm *vm, mrbc_value *regs EXT )
 
   mrbc_decref(&regs[a]);
 
-  mrbc_value val = mrbc_proc_new(vm, mrbc_irep_child_irep(vm->cur_irep, b));
+  regs[a] = mrbc_nil_value();
+
+  mrbc_irep *irep = child_irep(vm, b);
+  if( !irep ) return;
+
+  mrbc_value val = mrbc_proc_new(vm, irep);
   if( !val.proc ) return;	// ENOMEM
 
   regs[a] = val;
@@ -2551,11 +2911,14 @@ static inline void op_exec( mrbc_vm *vm, mrbc_value *regs EXT )
   FETCH_BB();
   assert( regs[a].tt == MRBC_TT_CLASS );
 
+  mrbc_irep *irep = child_irep(vm, b);
+  if( !irep ) return;
+
   // prepare callinfo
-  mrbc_push_callinfo(vm, 0, a, 0);
+  if( !mrbc_push_callinfo(vm, 0, a, 0) ) return;
 
   // target irep
-  vm->cur_irep = mrbc_irep_child_irep(vm->cur_irep, b);
+  vm->cur_irep = irep;
   vm->inst = vm->cur_irep->inst;
   vm->cur_regs += a;
 
@@ -2591,6 +2954,10 @@ static inline void op_def( mrbc_vm *vm, mrbc_value *regs EXT )
   method->c_func = 0;
   method->sym_id = sym_id;
   method->irep = proc->irep;
+#if defined(MRBC_USE_LAZY_IREP)
+  // not counted down. the irep of method is never evicted.
+  mrbc_irep_incref( method->irep );
+#endif
   method->next = cls->method_link;
   cls->method_link = method;
 
@@ -2607,6 +2974,7 @@ static inline void op_def( mrbc_vm *vm, mrbc_value *regs EXT )
     }
   }
 
+  mrbc_clear_method_cache();
   mrbc_set_symbol(&regs[a], sym_id);
 }
 
@@ -2648,6 +3016,8 @@ static inline void op_alias( mrbc_vm *vm, mrbc_value *regs EXT )
       break;
     }
   }
+
+  mrbc_clear_method_cache();
 }
 
 
@@ -2717,8 +3087,162 @@ static inline void op_unsupported( mrbc_vm *vm, mrbc_value *regs EXT )
   mrbc_raisef( vm, MRBC_CLASS(Exception),
 	       "Unimplemented opcode (0x%02x) found.", *(vm->inst - 1));
 }
+
+
+#if defined(MRBC_USE_SUPERINSTRUCTIONS)
+/*
+  Superinstructions.
+  The operands are read from the original instructions that follow
+  the rewritten opcode. When the fast path can not be used, only the
+  first instruction is executed and the rest are executed as usual.
+  They are never prefixed by OP_EXTn, so ext is always zero.
+*/
+#if defined(MRBC_SUPPORT_OP_EXT)
+#define NO_EXT , 0
+#else
+#define NO_EXT
+#endif
+
+//================================================================
+/*! OP_EQ_JMPIF ... OP_GE_JMPNOT
+
+  R[a] = R[a] <cmp> R[a+1]; if (!)R[a] pc+=b
+*/
+static inline void op_cmp_jmp( mrbc_vm *vm, mrbc_value *regs, int cmp, int jmp_if EXT )
+{
+  const uint8_t *p = vm->inst;		// a, OP_JMPxx, a, b(16bit)
+  unsigned int a = p[0];
+
+  if( regs[a].tt != MRBC_TT_INTEGER || regs[a+1].tt != MRBC_TT_INTEGER ) {
+    switch( cmp ) {
+    case OP_EQ: op_eq( vm, regs NO_EXT ); break;
+    case OP_LT: op_lt( vm, regs NO_EXT ); break;
+    case OP_LE: op_le( vm, regs NO_EXT ); break;
+    case OP_GT: op_gt( vm, regs NO_EXT ); break;
+    case OP_GE: op_ge( vm, regs NO_EXT ); break;
+    }
+    return;
+  }
+
+  mrbc_int_t x = regs[a].i;
+  mrbc_int_t y = regs[a+1].i;
+  int result = 0;
+  switch( cmp ) {
+  case OP_EQ: result = (x == y); break;
+  case OP_LT: result = (x <  y); break;
+  case OP_LE: result = (x <= y); break;
+  case OP_GT: result = (x >  y); break;
+  case OP_GE: result = (x >= y); break;
+  }
+
+  mrbc_set_bool( &regs[a], result );
+  vm->inst = p + 5;
+  if( result == jmp_if ) {
+    vm->inst += (int16_t)(p[3] << 8 | p[4]);
+  }
+}
+
+
+//================================================================
+/*! OP_LOADI16_ADD
+
+  R[a+1] = mrb_int(b); R[a] = R[a]+R[a+1]
+*/
+static inline void op_loadi16_add( mrbc_vm *vm, mrbc_value *regs EXT )
+{
+  const uint8_t *p = vm->inst;		// a+1, b(16bit), OP_ADD, a
+  unsigned int a = p[4];
+
+  if( regs[a].tt != MRBC_TT_INTEGER ) {
+    op_loadi16( vm, regs NO_EXT );
+    return;
+  }
+
+  mrbc_int_t b = (int16_t)(p[1] << 8 | p[2]);
+  mrbc_decref(&regs[a+1]);
+  mrbc_set_integer(&regs[a+1], b);
+  regs[a].i += b;
+  vm->inst = p + 5;
+}
+
+
+//================================================================
+/*! OP_GETIV_ADDI_SETIV
+
+  R[a] = ivget(Syms[b]); R[a] = R[a]+mrb_int(c); ivset(Syms[b],R[a])
+*/
+static inline void op_getiv_addi_setiv( mrbc_vm *vm, mrbc_value *regs EXT )
+{
+  const uint8_t *p = vm->inst;		// a, b, OP_ADDI, a, c, OP_SETIV, a, b
+  unsigned int a = p[0];
+  unsigned int b = p[1];
+  mrbc_instance *ins = mrbc_get_self( vm, regs )->instance;
+  mrbc_irep_cache *cache = mrbc_irep_cache_entry(vm->cur_irep, b);
+
+  if( cache->shape != ins->shape ||
+      ins->ivar[cache->slot].tt != MRBC_TT_INTEGER ) {
+    op_getiv( vm, regs NO_EXT );
+    return;
+  }
+
+  mrbc_value *v = &ins->ivar[cache->slot];
+  v->i += p[4];
+  mrbc_decref(&regs[a]);
+  regs[a] = *v;
+  vm->inst = p + 8;
+}
+
+
+//================================================================
+/*! OP_MOVE_SEND
+
+  R[a] = R[b]; R[a'] = R[a'].send(Syms[b'],R[a'+1]..)
+*/
+static inline void op_move_send( mrbc_vm *vm, mrbc_value *regs EXT )
+{
+  op_move( vm, regs NO_EXT );
+  vm->inst++;				// skip OP_SEND
+  op_send( vm, regs NO_EXT );
+}
+#undef NO_EXT
+#endif
 #undef EXT
 
+//================================================================
+/*! Search the exception handler and jump to it.
+
+  @param  vm	A pointer to VM.
+  @retval 0	jump to handler (rescue or ensure).
+  @retval 2	exception is not handled in this VM.
+*/
+static int jump_to_exception_handler( struct VM *vm )
+{
+  const mrbc_irep_catch_handler *handler;
+
+  while( 1 ) {
+    const mrbc_irep *irep = vm->cur_irep;
+    const mrbc_irep_catch_handler *catch_table =
+      (const mrbc_irep_catch_handler *)(irep->inst + irep->ilen);
+    uint32_t inst = vm->inst - irep->inst;
+    int cnt = irep->clen;
+
+    for( cnt--; cnt >= 0 ; cnt-- ) {
+      handler = catch_table + cnt;
+      if( (bin_to_uint32(handler->begin) < inst) &&
+	  (inst <= bin_to_uint32(handler->end)) ) goto JUMP_TO_HANDLER;
+    }
+
+    if( !vm->callinfo_tail ) return 2;	// return due to exception.
+    mrbc_pop_callinfo( vm );
+  }
+
+ JUMP_TO_HANDLER:
+  // jump to handler (rescue or ensure).
+  vm->inst = vm->cur_irep->inst + bin_to_uint32(handler->target);
+  return 0;
+}
+
+
 //================================================================
 /*! Fetch a bytecode and execute
 
@@ -2732,13 +3256,289 @@ int mrbc_vm_run( struct VM *vm )
 #if defined(MRBC_SUPPORT_OP_EXT)
   int ext = 0;
 #define EXT , ext
+#define RESET_EXT() (ext = 0)
 #else
 #define EXT
+#define RESET_EXT() ((void)0)
 #endif
+#if defined(MRBC_COUNT_INSTRUCTIONS)
+#define COUNT_INSTRUCTION() (vm->inst_count++)
+#else
+#define COUNT_INSTRUCTION() ((void)0)
+#endif
+#if defined(MRBC_PROFILE_OPCODES)
+#define PROFILE_OPCODE(op) mrbc_profile_opcode(op)
+#else
+#define PROFILE_OPCODE(op) ((void)0)
+#endif
+
+#if defined(MRBC_USE_THREADED_DISPATCH)
+  /*
+    Direct threaded dispatch.
+    Each handler jumps to the next one without going back to a loop.
+    The preemption flag is checked only after the opcodes that can raise
+    an exception, call a method, or stop the VM, and after jumps so that
+    a loop can still be preempted.
+  */
+  static const void * const dispatch_table[256] = {
+    [0 ... 255]    = &&L_UNSUPPORTED,
+    [OP_NOP]       = &&L_NOP,
+    [OP_MOVE]      = &&L_MOVE,
+    [OP_LOADL]     = &&L_LOADL,
+    [OP_LOADI]     = &&L_LOADI,
+    [OP_LOADINEG]  = &&L_LOADINEG,
+    [OP_LOADI__1]  = &&L_LOADI_N,
+    [OP_LOADI_0]   = &&L_LOADI_N,
+    [OP_LOADI_1]   = &&L_LOADI_N,
+    [OP_LOADI_2]   = &&L_LOADI_N,
+    [OP_LOADI_3]   = &&L_LOADI_N,
+    [OP_LOADI_4]   = &&L_LOADI_N,
+    [OP_LOADI_5]   = &&L_LOADI_N,
+    [OP_LOADI_6]   = &&L_LOADI_N,
+    [OP_LOADI_7]   = &&L_LOADI_N,
+    [OP_LOADI16]   = &&L_LOADI16,
+    [OP_LOADI32]   = &&L_LOADI32,
+    [OP_LOADSYM]   = &&L_LOADSYM,
+    [OP_LOADNIL]   = &&L_LOADNIL,
+    [OP_LOADSELF]  = &&L_LOADSELF,
+    [OP_LOADT]     = &&L_LOADT,
+    [OP_LOADF]     = &&L_LOADF,
+    [OP_GETGV]     = &&L_GETGV,
+    [OP_SETGV]     = &&L_SETGV,
+    [OP_GETIV]     = &&L_GETIV,
+    [OP_SETIV]     = &&L_SETIV,
+    [OP_GETCONST]  = &&L_GETCONST,
+    [OP_SETCONST]  = &&L_SETCONST,
+    [OP_GETMCNST]  = &&L_GETMCNST,
+    [OP_GETUPVAR]  = &&L_GETUPVAR,
+    [OP_SETUPVAR]  = &&L_SETUPVAR,
+    [OP_GETIDX]    = &&L_GETIDX,
+    [OP_SETIDX]    = &&L_SETIDX,
+    [OP_JMP]       = &&L_JMP,
+    [OP_JMPIF]     = &&L_JMPIF,
+    [OP_JMPNOT]    = &&L_JMPNOT,
+    [OP_JMPNIL]    = &&L_JMPNIL,
+    [OP_JMPUW]     = &&L_JMPUW,
+    [OP_EXCEPT]    = &&L_EXCEPT,
+    [OP_RESCUE]    = &&L_RESCUE,
+    [OP_RAISEIF]   = &&L_RAISEIF,
+    [OP_SSEND]     = &&L_SSEND,
+    [OP_SSENDB]    = &&L_SSENDB,
+    [OP_SEND]      = &&L_SEND,
+    [OP_SENDB]     = &&L_SENDB,
+    [OP_SUPER]     = &&L_SUPER,
+    [OP_ARGARY]    = &&L_ARGARY,
+    [OP_ENTER]     = &&L_ENTER,
+    [OP_KEY_P]     = &&L_KEY_P,
+    [OP_KEYEND]    = &&L_KEYEND,
+    [OP_KARG]      = &&L_KARG,
+    [OP_RETURN]    = &&L_RETURN,
+    [OP_RETURN_BLK] = &&L_RETURN_BLK,
+    [OP_BREAK]     = &&L_BREAK,
+    [OP_BLKPUSH]   = &&L_BLKPUSH,
+    [OP_ADD]       = &&L_ADD,
+    [OP_ADDI]      = &&L_ADDI,
+    [OP_SUB]       = &&L_SUB,
+    [OP_SUBI]      = &&L_SUBI,
+    [OP_MUL]       = &&L_MUL,
+    [OP_DIV]       = &&L_DIV,
+    [OP_EQ]        = &&L_EQ,
+    [OP_LT]        = &&L_LT,
+    [OP_LE]        = &&L_LE,
+    [OP_GT]        = &&L_GT,
+    [OP_GE]        = &&L_GE,
+    [OP_ARRAY]     = &&L_ARRAY,
+    [OP_ARRAY2]    = &&L_ARRAY2,
+    [OP_ARYCAT]    = &&L_ARYCAT,
+    [OP_ARYPUSH]   = &&L_ARYPUSH,
+    [OP_ARYDUP]    = &&L_ARYDUP,
+    [OP_AREF]      = &&L_AREF,
+    [OP_ASET]      = &&L_ASET,
+    [OP_APOST]     = &&L_APOST,
+    [OP_INTERN]    = &&L_INTERN,
+    [OP_SYMBOL]    = &&L_SYMBOL,
+    [OP_STRING]    = &&L_STRING,
+    [OP_STRCAT]    = &&L_STRCAT,
+    [OP_HASH]      = &&L_HASH,
+    [OP_HASHADD]   = &&L_HASHADD,
+    [OP_HASHCAT]   = &&L_HASHCAT,
+    [OP_BLOCK]     = &&L_METHOD,
+    [OP_METHOD]    = &&L_METHOD,
+    [OP_RANGE_INC] = &&L_RANGE_INC,
+    [OP_RANGE_EXC] = &&L_RANGE_EXC,
+    [OP_OCLASS]    = &&L_OCLASS,
+    [OP_CLASS]     = &&L_CLASS,
+    [OP_EXEC]      = &&L_EXEC,
+    [OP_DEF]       = &&L_DEF,
+    [OP_ALIAS]     = &&L_ALIAS,
+    [OP_SCLASS]    = &&L_SCLASS,
+    [OP_TCLASS]    = &&L_TCLASS,
+#if defined(MRBC_SUPPORT_OP_EXT)
+    [OP_EXT1]      = &&L_EXT1,
+    [OP_EXT2]      = &&L_EXT2,
+    [OP_EXT3]      = &&L_EXT3,
+#else
+    [OP_EXT1]      = &&L_EXT,
+    [OP_EXT2]      = &&L_EXT,
+    [OP_EXT3]      = &&L_EXT,
+#endif
+    [OP_STOP]      = &&L_STOP,
+#if defined(MRBC_USE_SUPERINSTRUCTIONS)
+    [OP_EQ_JMPIF]  = &&L_EQ_JMPIF,
+    [OP_EQ_JMPNOT] = &&L_EQ_JMPNOT,
+    [OP_LT_JMPIF]  = &&L_LT_JMPIF,
+    [OP_LT_JMPNOT] = &&L_LT_JMPNOT,
+    [OP_LE_JMPIF]  = &&L_LE_JMPIF,
+    [OP_LE_JMPNOT] = &&L_LE_JMPNOT,
+    [OP_GT_JMPIF]  = &&L_GT_JMPIF,
+    [OP_GT_JMPNOT] = &&L_GT_JMPNOT,
+    [OP_GE_JMPIF]  = &&L_GE_JMPIF,
+    [OP_GE_JMPNOT] = &&L_GE_JMPNOT,
+    [OP_LOADI16_ADD] = &&L_LOADI16_ADD,
+    [OP_GETIV_ADDI_SETIV] = &&L_GETIV_ADDI_SETIV,
+    [OP_MOVE_SEND] = &&L_MOVE_SEND,
+#endif
+  };
+  mrbc_value *regs;
+
+#define DISPATCH() do {						\
+    COUNT_INSTRUCTION();					\
+    PROFILE_OPCODE(*vm->inst);					\
+    regs = vm->cur_regs;					\
+    goto *dispatch_table[*vm->inst++];				\
+  } while(0)
+#define NEXT() do { RESET_EXT(); DISPATCH(); } while(0)
+#define CHECK() goto CHECK_PREEMPTION
+
+  DISPATCH();
+
+  L_NOP:         op_nop        (vm, regs EXT); NEXT();
+  L_MOVE:        op_move       (vm, regs EXT); NEXT();
+  L_LOADL:       op_loadl      (vm, regs EXT); NEXT();
+  L_LOADI:       op_loadi      (vm, regs EXT); NEXT();
+  L_LOADINEG:    op_loadineg   (vm, regs EXT); NEXT();
+  L_LOADI_N:     op_loadi_n    (vm, regs EXT); NEXT();
+  L_LOADI16:     op_loadi16    (vm, regs EXT); NEXT();
+  L_LOADI32:     op_loadi32    (vm, regs EXT); NEXT();
+  L_LOADSYM:     op_loadsym    (vm, regs EXT); NEXT();
+  L_LOADNIL:     op_loadnil    (vm, regs EXT); NEXT();
+  L_LOADSELF:    op_loadself   (vm, regs EXT); NEXT();
+  L_LOADT:       op_loadt      (vm, regs EXT); NEXT();
+  L_LOADF:       op_loadf      (vm, regs EXT); NEXT();
+  L_GETGV:       op_getgv      (vm, regs EXT); NEXT();
+  L_SETGV:       op_setgv      (vm, regs EXT); NEXT();
+  L_GETIV:       op_getiv      (vm, regs EXT); NEXT();
+  L_SETIV:       op_setiv      (vm, regs EXT); NEXT();
+  L_GETCONST:    op_getconst   (vm, regs EXT); CHECK();
+  L_SETCONST:    op_setconst   (vm, regs EXT); NEXT();
+  L_GETMCNST:    op_getmcnst   (vm, regs EXT); CHECK();
+  L_GETUPVAR:    op_getupvar   (vm, regs EXT); NEXT();
+  L_SETUPVAR:    op_setupvar   (vm, regs EXT); NEXT();
+  L_GETIDX:      op_getidx     (vm, regs EXT); CHECK();
+  L_SETIDX:      op_setidx     (vm, regs EXT); CHECK();
+  L_JMP:         op_jmp        (vm, regs EXT); CHECK();
+  L_JMPIF:       op_jmpif      (vm, regs EXT); CHECK();
+  L_JMPNOT:      op_jmpnot     (vm, regs EXT); CHECK();
+  L_JMPNIL:      op_jmpnil     (vm, regs EXT); CHECK();
+  L_JMPUW:       op_jmpuw      (vm, regs EXT); CHECK();
+  L_EXCEPT:      op_except     (vm, regs EXT); NEXT();
+  L_RESCUE:      op_rescue     (vm, regs EXT); CHECK();
+  L_RAISEIF:     op_raiseif    (vm, regs EXT); CHECK();
+  L_SSEND:       op_ssend      (vm, regs EXT); CHECK();
+  L_SSENDB:      op_ssendb     (vm, regs EXT); CHECK();
+  L_SEND:        op_send       (vm, regs EXT); CHECK();
+  L_SENDB:       op_sendb      (vm, regs EXT); CHECK();
+  L_SUPER:       op_super      (vm, regs EXT); CHECK();
+  L_ARGARY:      op_argary     (vm, regs EXT); CHECK();
+  L_ENTER:       op_enter      (vm, regs EXT); CHECK();
+  L_KEY_P:       op_key_p      (vm, regs EXT); CHECK();
+  L_KEYEND:      op_keyend     (vm, regs EXT); CHECK();
+  L_KARG:        op_karg       (vm, regs EXT); CHECK();
+  L_RETURN:      op_return     (vm, regs EXT); CHECK();
+  L_RETURN_BLK:  op_return_blk (vm, regs EXT); CHECK();
+  L_BREAK:       op_break      (vm, regs EXT); CHECK();
+  L_BLKPUSH:     op_blkpush    (vm, regs EXT); CHECK();
+  L_ADD:         op_add        (vm, regs EXT); CHECK();
+  L_ADDI:        op_addi       (vm, regs EXT); CHECK();
+  L_SUB:         op_sub        (vm, regs EXT); CHECK();
+  L_SUBI:        op_subi       (vm, regs EXT); CHECK();
+  L_MUL:         op_mul        (vm, regs EXT); CHECK();
+  L_DIV:         op_div        (vm, regs EXT); CHECK();
+  L_EQ:          op_eq         (vm, regs EXT); CHECK();
+  L_LT:          op_lt         (vm, regs EXT); CHECK();
+  L_LE:          op_le         (vm, regs EXT); CHECK();
+  L_GT:          op_gt         (vm, regs EXT); CHECK();
+  L_GE:          op_ge         (vm, regs EXT); CHECK();
+  L_ARRAY:       op_array      (vm, regs EXT); NEXT();
+  L_ARRAY2:      op_array2     (vm, regs EXT); NEXT();
+  L_ARYCAT:      op_arycat     (vm, regs EXT); NEXT();
+  L_ARYPUSH:     op_arypush    (vm, regs EXT); NEXT();
+  L_ARYDUP:      op_arydup     (vm, regs EXT); NEXT();
+  L_AREF:        op_aref       (vm, regs EXT); NEXT();
+  L_ASET:        op_aset       (vm, regs EXT); NEXT();
+  L_APOST:       op_apost      (vm, regs EXT); NEXT();
+  L_INTERN:      op_intern     (vm, regs EXT); NEXT();
+  L_SYMBOL:      op_symbol     (vm, regs EXT); CHECK();
+  L_STRING:      op_string     (vm, regs EXT); NEXT();
+  L_STRCAT:      op_strcat     (vm, regs EXT); CHECK();
+  L_HASH:        op_hash       (vm, regs EXT); NEXT();
+  L_HASHADD:     op_hashadd    (vm, regs EXT); NEXT();
+  L_HASHCAT:     op_hashcat    (vm, regs EXT); NEXT();
+  L_METHOD:      op_method     (vm, regs EXT); CHECK();
+  L_RANGE_INC:   op_range_inc  (vm, regs EXT); NEXT();
+  L_RANGE_EXC:   op_range_exc  (vm, regs EXT); NEXT();
+  L_OCLASS:      op_oclass     (vm, regs EXT); NEXT();
+  L_CLASS:       op_class      (vm, regs EXT); CHECK();
+  L_EXEC:        op_exec       (vm, regs EXT); CHECK();
+  L_DEF:         op_def        (vm, regs EXT); NEXT();
+  L_ALIAS:       op_alias      (vm, regs EXT); CHECK();
+  L_SCLASS:      op_sclass     (vm, regs EXT); NEXT();
+  L_TCLASS:      op_tclass     (vm, regs EXT); NEXT();
+#if defined(MRBC_SUPPORT_OP_EXT)
+  L_EXT1:        ext = 1; DISPATCH();
+  L_EXT2:        ext = 2; DISPATCH();
+  L_EXT3:        ext = 3; DISPATCH();
+#else
+  L_EXT:         op_ext        (vm, regs EXT); CHECK();
+#endif
+  L_STOP:        op_stop       (vm, regs EXT); CHECK();
+#if defined(MRBC_USE_SUPERINSTRUCTIONS)
+  L_EQ_JMPIF:    op_cmp_jmp    (vm, regs, OP_EQ, 1 EXT); CHECK();
+  L_EQ_JMPNOT:   op_cmp_jmp    (vm, regs, OP_EQ, 0 EXT); CHECK();
+  L_LT_JMPIF:    op_cmp_jmp    (vm, regs, OP_LT, 1 EXT); CHECK();
+  L_LT_JMPNOT:   op_cmp_jmp    (vm, regs, OP_LT, 0 EXT); CHECK();
+  L_LE_JMPIF:    op_cmp_jmp    (vm, regs, OP_LE, 1 EXT); CHECK();
+  L_LE_JMPNOT:   op_cmp_jmp    (vm, regs, OP_LE, 0 EXT); CHECK();
+  L_GT_JMPIF:    op_cmp_jmp    (vm, regs, OP_GT, 1 EXT); CHECK();
+  L_GT_JMPNOT:   op_cmp_jmp    (vm, regs, OP_GT, 0 EXT); CHECK();
+  L_GE_JMPIF:    op_cmp_jmp    (vm, regs, OP_GE, 1 EXT); CHECK();
+  L_GE_JMPNOT:   op_cmp_jmp    (vm, regs, OP_GE, 0 EXT); CHECK();
+  L_LOADI16_ADD: op_loadi16_add(vm, regs EXT); NEXT();
+  L_GETIV_ADDI_SETIV: op_getiv_addi_setiv(vm, regs EXT); NEXT();
+  L_MOVE_SEND:   op_move_send  (vm, regs EXT); CHECK();
+#endif
+  L_UNSUPPORTED: op_unsupported(vm, regs EXT); CHECK();
+
+ CHECK_PREEMPTION:
+  RESET_EXT();
+  if( !vm->flag_preemption ) DISPATCH();	// execute next ope code.
+  if( !mrbc_israised(vm) ) return vm->flag_stop; // normal return.
+
+  // Handle exception
+  vm->flag_preemption = 0;
+  if( jump_to_exception_handler( vm ) != 0 ) return 2;
+  DISPATCH();
+
+#undef DISPATCH
+#undef NEXT
+#undef CHECK
 
+#else
   while( 1 ) {
     mrbc_value *regs = vm->cur_regs;
     uint8_t op = *vm->inst++;		// Dispatch
+    COUNT_INSTRUCTION();
+    PROFILE_OPCODE(op);
 
     switch( op ) {
     case OP_NOP:        op_nop        (vm, regs EXT); break;
@@ -2853,40 +3653,36 @@ int mrbc_vm_run( struct VM *vm )
     case OP_EXT3:       op_ext        (vm, regs EXT); break;
 #endif
     case OP_STOP:       op_stop       (vm, regs EXT); break;
+#if defined(MRBC_USE_SUPERINSTRUCTIONS)
+    case OP_EQ_JMPIF:   op_cmp_jmp    (vm, regs, OP_EQ, 1 EXT); break;
+    case OP_EQ_JMPNOT:  op_cmp_jmp    (vm, regs, OP_EQ, 0 EXT); break;
+    case OP_LT_JMPIF:   op_cmp_jmp    (vm, regs, OP_LT, 1 EXT); break;
+    case OP_LT_JMPNOT:  op_cmp_jmp    (vm, regs, OP_LT, 0 EXT); break;
+    case OP_LE_JMPIF:   op_cmp_jmp    (vm, regs, OP_LE, 1 EXT); break;
+    case OP_LE_JMPNOT:  op_cmp_jmp    (vm, regs, OP_LE, 0 EXT); break;
+    case OP_GT_JMPIF:   op_cmp_jmp    (vm, regs, OP_GT, 1 EXT); break;
+    case OP_GT_JMPNOT:  op_cmp_jmp    (vm, regs, OP_GT, 0 EXT); break;
+    case OP_GE_JMPIF:   op_cmp_jmp    (vm, regs, OP_GE, 1 EXT); break;
+    case OP_GE_JMPNOT:  op_cmp_jmp    (vm, regs, OP_GE, 0 EXT); break;
+    case OP_LOADI16_ADD: op_loadi16_add(vm, regs EXT); break;
+    case OP_GETIV_ADDI_SETIV: op_getiv_addi_setiv(vm, regs EXT); break;
+    case OP_MOVE_SEND:  op_move_send  (vm, regs EXT); break;
+#endif
     default:		op_unsupported(vm, regs EXT); break;
     } // end switch.
 
-#undef EXT
-#if defined(MRBC_SUPPORT_OP_EXT)
-    ext = 0;
-#endif
+    RESET_EXT();
     if( !vm->flag_preemption ) continue;	// execute next ope code.
     if( !mrbc_israised(vm) ) return vm->flag_stop; // normal return.
 
-
     // Handle exception
     vm->flag_preemption = 0;
-    const mrbc_irep_catch_handler *handler;
-
-    while( 1 ) {
-      const mrbc_irep *irep = vm->cur_irep;
-      const mrbc_irep_catch_handler *catch_table =
-	(const mrbc_irep_catch_handler *)(irep->inst + irep->ilen);
-      uint32_t inst = vm->inst - irep->inst;
-      int cnt = irep->clen;
-
-      for( cnt--; cnt >= 0 ; cnt-- ) {
-	handler = catch_table + cnt;
-	if( (bin_to_uint32(handler->begin) < inst) &&
-	    (inst <= bin_to_uint32(handler->end)) ) goto JUMP_TO_HANDLER;
-      }
-
-      if( !vm->callinfo_tail ) return 2;	// return due to exception.
-      mrbc_pop_callinfo( vm );
-    }
-
-  JUMP_TO_HANDLER:
-    // jump to handler (rescue or ensure).
-    vm->inst = vm->cur_irep->inst + bin_to_uint32(handler->target);
+    if( jump_to_exception_handler( vm ) != 0 ) return 2;
   }
+#endif
+
+#undef EXT
+#undef RESET_EXT
+#undef COUNT_INSTRUCTION
+#undef PROFILE_OPCODE
 }
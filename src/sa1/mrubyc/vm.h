@@ -32,6 +32,14 @@
 extern "C" {
 #endif
 /***** Constat values *******************************************************/
+#if defined(MRBC_PROFILE_OPCODES)
+//! size of the opcode pair table. (power of 2)
+#if !defined(MRBC_OPCODE_PAIR_TABLE_SIZE)
+#define MRBC_OPCODE_PAIR_TABLE_SIZE 128
+#endif
+#endif
+
+
 /***** Macros ***************************************************************/
 /***** Typedefs *************************************************************/
 //================================================================
@@ -50,21 +58,47 @@ typedef struct IREP {
   uint32_t ilen;		//!< num of bytes in OpCode
   uint16_t plen;		//!< num of pools
   uint16_t slen;		//!< num of symbols
-  uint16_t ofs_ireps;		//!< offset of data->tbl_ireps. (32bit aligned)
 
-  const uint8_t *inst;		//!< pointer to instruction in RITE binary
+  const uint8_t *inst;		//!< pointer to instruction in RITE binary or RAM
   const uint8_t *pool;		//!< pointer to pool in RITE binary
+  const mrbc_sym *tbl_syms;	//!< symbol ids[slen], and ivar ids[slen]
+  const uint16_t *tbl_pools;	//!< pool data offsets[plen]
+  struct IREP * const *tbl_ireps;	//!< child ireps[rlen]
+  struct IREP_CACHE *tbl_cache;	//!< inline caches[slen] (always in RAM)
+#if defined(MRBC_USE_LAZY_IREP)
+  const struct IREP_INDEX *index;	//!< own entry of IREP index, or NULL.
+  uint16_t ref_count;		//!< num of Procs and methods refer to this.
+#endif
 
-  uint8_t data[];		//!< variable data. (see load.c)
+  uint8_t data[];		//!< variable data of loaded IREP. (see load.c)
 				//!<  mrbc_sym   tbl_syms[slen]
+				//!<  mrbc_sym   tbl_ivars[slen]
 				//!<  uint16_t   tbl_pools[plen]
 				//!<  mrbc_irep *tbl_ireps[rlen]
+				//!<  mrbc_irep_cache tbl_cache[slen]
+				//!<  uint8_t    inst[]  (MRBC_USE_SUPERINSTRUCTIONS)
+				//!< pre-linked IREP has no data. (see load.h)
 } mrbc_irep;
 typedef struct IREP mrb_irep;
 
+
+#if defined(MRBC_USE_LAZY_IREP)
+//================================================================
+/*!@brief
+  IREP index.
+
+  Made by the first scan of IREP section, in order of the IREP records.
+  The children of an IREP follow its entry, each with its own subtree.
+*/
+typedef struct IREP_INDEX {
+  const uint8_t *bin;		//!< pointer to IREP record in RITE binary.
+  uint16_t n_ireps;		//!< num of IREPs in this subtree. (includes itself)
+} mrbc_irep_index;
+#endif
+
 // mrbc_irep manipulate macro.
 //! get a symbol id table pointer.
-#define mrbc_irep_tbl_syms(irep)	((mrbc_sym *)(irep)->data)
+#define mrbc_irep_tbl_syms(irep)	((irep)->tbl_syms)
 
 //! get a n'th symbol id in irep
 #define mrbc_irep_symbol_id(irep, n)	mrbc_irep_tbl_syms(irep)[(n)]
@@ -73,9 +107,16 @@ typedef struct IREP mrb_irep;
 #define mrbc_irep_symbol_cstr(irep, n)	mrbc_symid_to_str( mrbc_irep_symbol_id(irep, n) )
 
 
+//! get a instance variable symbol id table pointer.
+#define mrbc_irep_tbl_ivars(irep) \
+  ( mrbc_irep_tbl_syms(irep) + (irep)->slen )
+
+//! get a n'th symbol id as instance variable name. ('@' is stripped)
+#define mrbc_irep_ivar_id(irep, n)	mrbc_irep_tbl_ivars(irep)[(n)]
+
+
 //! get a pool data offset table pointer.
-#define mrbc_irep_tbl_pools(irep) \
-  ( (uint16_t *) ((irep)->data + (irep)->slen * sizeof(mrbc_sym)) )
+#define mrbc_irep_tbl_pools(irep)	((irep)->tbl_pools)
 
 //! get a pointer to n'th pool data.
 #define mrbc_irep_pool_ptr(irep, n) \
@@ -83,14 +124,64 @@ typedef struct IREP mrb_irep;
 
 
 //! get a child irep table pointer.
-#define mrbc_irep_tbl_ireps(irep) \
-  ( (mrbc_irep **) ((irep)->data + (irep)->ofs_ireps * 4) )
+#define mrbc_irep_tbl_ireps(irep)	((irep)->tbl_ireps)
 
 //! get a n'th child irep
 #define mrbc_irep_child_irep(irep, n) \
   ( mrbc_irep_tbl_ireps(irep)[(n)] )
 
 
+//! get a inline cache table pointer.
+#define mrbc_irep_tbl_cache(irep)	((irep)->tbl_cache)
+
+#if defined(MRBC_USE_LAZY_IREP)
+//! count a reference from Proc or method. (lazy loaded irep only)
+#define mrbc_irep_incref(irep) \
+  do { if( (irep)->index ) (irep)->ref_count++; } while(0)
+
+//! release a reference from Proc.
+#define mrbc_irep_decref(irep) \
+  do { if( (irep)->index ) (irep)->ref_count--; } while(0)
+#endif
+
+//! get a inline cache entry for n'th symbol.
+#define mrbc_irep_cache_entry(irep, n) \
+  ( mrbc_irep_tbl_cache(irep) + (n) )
+
+
+
+//================================================================
+/*!@brief
+  Inline cache.
+
+  One entry per symbol in IREP. The symbol operand of the instruction
+  selects the entry, and its usage depends on the instruction.
+  A symbol may be used both as a method name and as a constant name,
+  so the method generations (1-0x7fff) and the constant generations
+  (0x8000-0xffff) never overlap. Zero means invalid entry.
+  All entries are cleared when either generation wraps around.
+*/
+typedef struct IREP_CACHE {
+  union {
+    //! OP_SEND family, OP_GETCONST and OP_GETMCNST.
+    //! valid while the class and the generation match.
+    struct {
+      mrbc_class *cls;		//!< receiver class or constant scope.
+      uint16_t generation;	//!< mrbc_method_cache_generation or
+				//!< mrbc_const_cache_generation at cached.
+      union {
+	mrbc_method method;	//!< found method.
+	mrbc_value *value;	//!< found constant.
+      };
+    };
+    //! OP_GETIV and OP_SETIV. valid while the shape matches.
+    struct {
+      struct RShape *shape;	//!< shape of self.
+      uint8_t slot;		//!< slot index of the instance variable.
+    };
+  };
+} mrbc_irep_cache;
+
 
 //================================================================
 /*!@brief
@@ -139,6 +230,10 @@ typedef struct VM {
   unsigned int flag_need_memfree : 1;
   unsigned int flag_stop : 1;
   unsigned int flag_permanence : 1;
+  unsigned int flag_prelinked : 1;	//!< top_irep is pre-linked in ROM.
+#if defined(MRBC_USE_COMPRESSED_IREP)
+  unsigned int flag_compressed : 1;	//!< top_irep is loaded from compressed IREP section.
+#endif
 
   uint16_t	  regs_size;		//!< size of regs[]
 
@@ -148,17 +243,35 @@ typedef struct VM {
   mrbc_value	  *cur_regs;		//!< Current register top.
   mrbc_class      *target_class;	//!< Target class.
   mrbc_callinfo	  *callinfo_tail;	//!< Last point of CALLINFO link.
+  mrbc_callinfo	  *callinfo_stack;	//!< CALLINFO stack bottom.
+  mrbc_callinfo	  *callinfo_end;	//!< CALLINFO stack limit.
   mrbc_proc	  *ret_blk;		//!< Return block.
 
   mrbc_value	  exception;		//!< Raised exception or nil.
+#if defined(MRBC_COUNT_INSTRUCTIONS)
+  uint32_t	  inst_count;		//!< Number of executed instructions.
+#endif
   mrbc_value      regs[];
 } mrbc_vm;
 typedef struct VM mrb_vm;
 
 
+#if defined(MRBC_PROFILE_OPCODES)
+//================================================================
+/*!@brief
+  Executed count of an opcode pair.
+*/
+typedef struct OPCODE_PAIR_COUNT {
+  uint16_t ops;			//!< (previous opcode << 8) | opcode
+  uint32_t count;		//!< executed count. (0 is empty entry)
+} mrbc_opcode_pair_count;
+#endif
+
+
 /***** Global variables *****************************************************/
 /***** Function prototypes **************************************************/
 void mrbc_cleanup_vm(void);
+void mrbc_clear_all_inline_cache(void);
 mrbc_sym mrbc_get_callee_symid(struct VM *vm);
 const char *mrbc_get_callee_name(struct VM *vm);
 mrbc_callinfo *mrbc_push_callinfo(struct VM *vm, mrbc_sym method_id, int reg_offset, int n_args);
@@ -169,6 +282,13 @@ void mrbc_vm_close(struct VM *vm);
 void mrbc_vm_begin(struct VM *vm);
 void mrbc_vm_end(struct VM *vm);
 int mrbc_vm_run(struct VM *vm);
+#if defined(MRBC_PROFILE_OPCODES)
+void mrbc_profile_opcode(int op);
+void mrbc_clear_opcode_profile(void);
+int mrbc_get_opcode_profile(int flag_pair, int n, uint16_t ops[], uint32_t counts[]);
+uint32_t mrbc_get_opcode_pair_dropped(void);
+const char *mrbc_opcode_name(int op);
+#endif
 
 
 /***** Inline functions *****************************************************/
@@ -25,9 +25,15 @@
 #define MAX_REGS_SIZE 110
 #endif
 
+// maximum depth of method calls (size of callinfo stack)
+#if !defined(MAX_CALLINFO_SIZE)
+#define MAX_CALLINFO_SIZE 32
+#endif
+
 // maximum number of symbols
+//  the symbol table grows as symbols are added, up to this number.
 #if !defined(MAX_SYMBOLS_COUNT)
-#define MAX_SYMBOLS_COUNT 255
+#define MAX_SYMBOLS_COUNT 4096
 #endif
 
 
@@ -103,6 +109,40 @@
 // If you use LIBC malloc instead of mruby/c malloc
 //#define MRBC_ALLOC_LIBC
 
+// Allocate the fixed size objects (Array, String, Proc, ...) from the
+// free lists of each size class, in front of the allocator above.
+//#define MRBC_USE_SLAB_ALLOC
+
+// Allocate the objects of a frame from the frame arena, between
+// mrbc_frame_arena_begin() and mrbc_frame_arena_end().
+// An object which outlives the frame keeps its chunk until it is released,
+// and the arena falls back to the heap when no chunk has room.
+//#define MRBC_USE_FRAME_ARENA
+//#define MRBC_FRAME_ARENA_CHUNKS 8
+//#define MRBC_FRAME_ARENA_CHUNK_SIZE 512
+
+// Use direct threaded dispatch (computed goto) in mrbc_vm_run().
+//  Requires GCC compatible "labels as values" extension.
+//#define MRBC_USE_THREADED_DISPATCH
+
+// Count executed instructions in VM::inst_count. (for benchmark)
+//#define MRBC_COUNT_INSTRUCTIONS
+
+// Count executed opcodes and opcode pairs. (see mrbc_get_opcode_profile)
+//#define MRBC_PROFILE_OPCODES
+
+// Rewrite frequent instruction sequences to superinstructions at load time.
+// Instructions are copied to RAM.
+//#define MRBC_USE_SUPERINSTRUCTIONS
+
+// Load child IREPs (methods, blocks and class bodies) at the first use,
+// instead of all at once. Unused IREPs are evicted when memory is low.
+//#define MRBC_USE_LAZY_IREP
+
+// Accept the compressed IREP section made by support/mrbc_compress.rb.
+// Each IREP is inflated into RAM when it is loaded.
+//#define MRBC_USE_COMPRESSED_IREP
+
 // #define MRBC_OUT_OF_MEMORY() mrbc_alloc_print_memory_pool(); hal_abort(0)
 // #define MRBC_ABORT_BY_EXCEPTION(vm) mrbc_p( &vm->exception ); hal_abort(0)
 
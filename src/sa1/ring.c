@@ -0,0 +1,49 @@
+#include <snes.h>
+
+#include "bwram.h"
+#include "ring.h"
+
+// allocated by bwram_alloc(), because BW-RAM is seen at the same address
+// from S-CPU.
+static snesw_ring *ring;
+
+int snes_ring_init(void) {
+  ring = bwram_alloc(sizeof(snesw_ring));
+  if (ring == NULL) {
+    return -1;
+  }
+
+  ring->head = 0;
+  ring->tail = 0;
+  call_s_cpu(snesw_ring_attach, sizeof(snesw_ring *), ring);
+
+  return 0;
+}
+
+// S-CPU waits in listen_call_from_sa1() and drains the ring only after a
+// call, so waiting for the tail to move would never end. Have S-CPU run
+// the queued commands now instead.
+static void drain(void) { call_s_cpu(snesw_ring_drain, 0); }
+
+// Returns the next entry. If the ring is full, runs the queued commands.
+volatile snesw_command *snes_ring_reserve(u8 id) {
+  if ((u8)(ring->head - ring->tail) == SNESW_RING_SIZE) {
+    drain();
+  }
+
+  volatile snesw_command *c =
+      &ring->commands[ring->head & (SNESW_RING_SIZE - 1)];
+  c->id = id;
+
+  return c;
+}
+
+// Passes the entry from snes_ring_reserve() to S-CPU.
+void snes_ring_commit(void) { ring->head++; }
+
+// Returns after S-CPU has run all the queued commands.
+void snes_ring_flush(void) {
+  if (ring->tail != ring->head) {
+    drain();
+  }
+}
@@ -0,0 +1,17 @@
+#ifndef RING_H_
+#define RING_H_
+
+#include <snes.h>
+
+#include "snesw.h"
+
+// Commands to S-CPU which need no result are queued in the ring, and SA-1
+// goes on without waiting. S-CPU runs them after each call_s_cpu(), so
+// call snes_ring_flush() before a call_s_cpu() which depends on them.
+
+int snes_ring_init(void);
+volatile snesw_command *snes_ring_reserve(u8 id);
+void snes_ring_commit(void);
+void snes_ring_flush(void);
+
+#endif  // RING_H_
@@ -0,0 +1,106 @@
+#!/usr/bin/env ruby
+#
+# Generate a minimal perfect hash of the built-in symbols.
+#
+#  (usage)
+#  make_symbol_hash.rb [-o output] [_autogen_builtin_symbol.h]
+#
+# The hash maps every name in builtin_symbols[] to its symbol ID:
+#
+#   h  = calc_hash(str)                                  (see symbol.c)
+#   d  = builtin_symbol_hash_disp[ h % DISP_SIZE ]
+#   id = builtin_symbol_hash_id[ (h ^ d) % HASH_SIZE ]
+#
+# and symbol.c compares the name once to reject the other strings.
+#
+# The output depends only on the input. Buckets are ordered by size and
+# then by key, and the displacements are tried in a fixed order from
+# SEED, so that any Ruby version generates the same header.
+#
+
+require "optparse"
+
+DISP_SIZES = [32, 64, 128, 256]
+SEED = 0
+
+output = "_autogen_builtin_symbol_hash.h"
+OptionParser.new do |opt|
+  opt.on("-o FILE", "output file.") { |v| output = v }
+  opt.parse!(ARGV)
+end
+input = ARGV[0] || "_autogen_builtin_symbol.h"
+
+# read builtin_symbols[] in symbol ID order.
+src = File.read(input)
+table = src[/builtin_symbols\[\] = \{(.*?)\};/m, 1] or abort "#{input}: builtin_symbols not found."
+names = table.scan(/^\s*"((?:[^"\\]|\\.)*)",/).map { |m| m[0].gsub(/\\(.)/, '\1') }
+n = names.size
+abort "too many builtin symbols." if n > 256
+
+# same as calc_hash() in symbol.c
+def calc_hash(str)
+  str.each_byte.inject(0) { |h, c| (h * 17 + c) & 0xffff }
+end
+
+hashes = names.map { |s| calc_hash(s) }
+
+# hash and displace. place larger buckets first.
+def build(hashes, disp_size)
+  n = hashes.size
+  buckets = Hash.new { |h, k| h[k] = [] }
+  hashes.each_with_index { |h, id| buckets[h % disp_size] << id }
+
+  disp = Array.new(disp_size, 0)
+  ids = Array.new(n)
+  buckets.keys.sort_by { |key| [-buckets[key].size, key] }.each do |key|
+    bucket = buckets[key].sort
+    slots = nil
+    d = (0..255).map { |i| (SEED + i) & 255 }.find do |v|
+      slots = bucket.map { |id| (hashes[id] ^ v) % n }
+      slots.uniq.size == slots.size && slots.all? { |s| ids[s].nil? }
+    end
+    return nil unless d
+
+    disp[key] = d
+    bucket.zip(slots).each { |id, s| ids[s] = id }
+  end
+
+  [disp, ids]
+end
+
+disp_size = disp = ids = nil
+DISP_SIZES.each do |size|
+  disp, ids = build(hashes, size)
+  if disp
+    disp_size = size
+    break
+  end
+end
+abort "can't make perfect hash." unless disp_size
+
+def c_array(values)
+  values.each_slice(16).map { |a| "  " + a.join(", ") + "," }.join("\n")
+end
+
+File.open(output, "w") do |f|
+  f.puts <<~EOS
+    /* Auto generated by make_symbol_hash.rb */
+    #ifndef MRBC_SRC_AUTOGEN_BUILTIN_SYMBOL_HASH_H_
+    #define MRBC_SRC_AUTOGEN_BUILTIN_SYMBOL_HASH_H_
+
+    #define MRBC_BUILTIN_SYMBOL_HASH_DISP_SIZE #{disp_size}
+    #define MRBC_BUILTIN_SYMBOL_HASH_SIZE #{n}
+
+    #if defined(MRBC_DEFINE_SYMBOL_TABLE)
+    static const uint8_t builtin_symbol_hash_disp[] = {
+    #{c_array(disp)}
+    };
+
+    static const uint8_t builtin_symbol_hash_id[] = {
+    #{c_array(ids)}
+    };
+    #endif
+
+    #endif
+  EOS
+end
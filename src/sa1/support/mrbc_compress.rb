@@ -0,0 +1,170 @@
+#!/usr/bin/env ruby
+#
+# Compress the IREP section of .mrb file, and emit it as C array.
+#
+#  (usage)
+#  mrbc_compress.rb [-B name] [-o output] file.mrb
+#
+# The IREP section is replaced with the compressed IREP section "IRPZ".
+# Each IREP record becomes one block, in the same order:
+#
+#   0000_0000  block size
+#   0000_0000  size of inflated record
+#   0000       n of child irep
+#   0000       n of pool
+#   ...        SYMS block (not compressed)
+#   ...        LZ4 block of the IREP record, without SYMS block.
+#
+# Symbol names are left uncompressed in ROM, because the symbol table
+# refers to them. The other sections are copied as is.
+# The ROM size of each IREP is reported to stdout.
+#
+
+require "optparse"
+
+SIZE_RITE_BINARY_HEADER = 20
+SIZE_RITE_SECTION_HEADER = 12
+SIZE_RITE_CATCH_HANDLER = 13
+
+# LZ4 block format parameters.
+MIN_MATCH = 4
+LAST_LITERALS = 5
+MF_LIMIT = 12
+MAX_OFFSET = 65535
+
+name = "mrbbuf"
+output = nil
+OptionParser.new do |opt|
+  opt.on("-B NAME", "name of the array.") { |v| name = v }
+  opt.on("-o FILE", "output file.") { |v| output = v }
+  opt.parse!(ARGV)
+end
+input = ARGV[0] or abort "no input file."
+output ||= input.sub(/\.mrb\z/, "") + ".c"
+
+def lz4_length(out, n)
+  while n >= 255
+    out << 255
+    n -= 255
+  end
+  out << n
+end
+
+def lz4_sequence(out, literals, offset = nil, match_len = 0)
+  lit = literals.size
+  ml = match_len - MIN_MATCH
+  out << ([lit, 15].min << 4 | (offset ? [ml, 15].min : 0))
+  lz4_length(out, lit - 15) if lit >= 15
+  out.concat(literals)
+  return unless offset
+
+  out << (offset & 0xff) << (offset >> 8)
+  lz4_length(out, ml - 15) if ml >= 15
+end
+
+# greedy LZ4 block compressor.
+def lz4_compress(src)
+  n = src.size
+  out = []
+  table = {}
+  anchor = 0
+  i = 0
+  while i + MF_LIMIT < n
+    key = src[i, MIN_MATCH]
+    ref = table[key]
+    table[key] = i
+    if ref && i - ref <= MAX_OFFSET
+      len = MIN_MATCH
+      len += 1 while i + len < n - LAST_LITERALS && src[ref + len] == src[i + len]
+      lz4_sequence(out, src[anchor...i], i - ref, len)
+      i += len
+      anchor = i
+    else
+      i += 1
+    end
+  end
+  lz4_sequence(out, src[anchor..])
+  out
+end
+
+Irep = Struct.new(:rom_size, :ram_size, :syms_size)
+
+# compress one IREP record and its children.
+def compress_irep(bin, pos, blocks, ireps)
+  rlen, clen, ilen = bin[pos + 8, 8].unpack("n2N")
+  p = pos + 16 + ilen + SIZE_RITE_CATCH_HANDLER * clen
+  plen = bin[p, 2].unpack1("n")
+  p += 2
+  plen.times do
+    tt = bin.getbyte(p)
+    p += 1
+    case tt
+    when 0, 2 then p += bin[p, 2].unpack1("n") + 3	# string
+    when 1 then p += 4					# int32
+    when 3, 5 then p += 8				# int64, float
+    else abort "unknown pool type #{tt}."
+    end
+  end
+  syms_top = p
+  slen = bin[p, 2].unpack1("n")
+  p += 2
+  slen.times { p += 2 + bin[p, 2].unpack1("n") + 1 }
+
+  record = bin[pos...syms_top].bytes
+  syms = bin[syms_top...p]
+  z = lz4_compress(record).pack("C*")
+  size = 12 + syms.bytesize + z.bytesize
+  blocks << [size, record.size, rlen, plen].pack("NNnn") + syms + z
+  ireps << Irep.new(size, record.size, syms.bytesize)
+
+  len = bin[pos, 4].unpack1("N")
+  rlen.times do
+    len += compress_irep(bin, pos + len, blocks, ireps)
+  end
+  len
+end
+
+
+bin = File.binread(input)
+abort "#{input}: Illegal bytecode." unless bin[0, 4] == "RITE"
+abort "#{input}: Bytecode version mismatch." unless bin[4, 4] == "0300"
+
+sections = []
+ireps = []
+pos = SIZE_RITE_BINARY_HEADER
+while pos < bin.size
+  id = bin[pos, 4]
+  size = bin[pos + 4, 4].unpack1("N")
+  if id == "IREP"
+    blocks = []
+    compress_irep(bin, pos + SIZE_RITE_SECTION_HEADER, blocks, ireps)
+    body = blocks.join
+    sections << "IRPZ" + [body.bytesize + SIZE_RITE_SECTION_HEADER].pack("N") +
+                bin[pos + 8, 4] + body
+  else
+    sections << bin[pos, size]
+  end
+  pos += size
+  break if id == "END\0"
+end
+
+body = sections.join
+mrb = bin[0, 8] + [SIZE_RITE_BINARY_HEADER + body.bytesize].pack("N") +
+      bin[12, 8] + body
+
+File.open(output, "w") do |f|
+  f.puts <<~EOS
+    /* Auto generated by mrbc_compress.rb from #{File.basename(input)} */
+    #include <stdint.h>
+    const uint8_t #{name}[] = {
+  EOS
+  mrb.bytes.each_slice(16) { |a| f.puts a.map { |c| format("0x%02x,", c) }.join }
+  f.puts "};"
+end
+
+# report
+puts "irep  ROM(syms)     RAM"
+ireps.each_with_index do |irep, i|
+  printf("%4d %5d(%5d) %5d\n", i, irep.rom_size, irep.syms_size, irep.ram_size)
+end
+printf("total: %d -> %d bytes\n", bin.bytesize, mrb.bytesize)
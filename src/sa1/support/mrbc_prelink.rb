@@ -0,0 +1,301 @@
+#!/usr/bin/env ruby
+#
+# Pre-link the IREP tree of .mrb file into C data.
+#
+#  (usage)
+#  mrbc_prelink.rb [-B name] [-o output] [-s] [-I mrubyc_dir] file.mrb
+#
+# Does the same as load_irep() in load.c at build time, and emits
+#
+#   const mrbc_prelinked <name>_prelinked;
+#
+# The ireps, symbol ID tables, pool offset tables and instructions are
+# const, and placed in ROM. Only the inline caches are placed in RAM.
+#
+# Built-in symbols are resolved by _autogen_builtin_symbol.h.
+# The other symbols are numbered from 256, and have to be registered by
+# mrbc_prelink_symbols() before any other symbols are made. (see main.c)
+#
+# -s fuses the instructions like MRBC_USE_SUPERINSTRUCTIONS does at load
+# time. Keep fuse_sequence() below in sync with load.c.
+#
+
+require "optparse"
+
+OFFSET_BUILTIN_SYMBOL = 256
+SIZE_RITE_BINARY_HEADER = 20
+SIZE_RITE_SECTION_HEADER = 12
+SIZE_RITE_CATCH_HANDLER = 13
+
+name = "mrbbuf"
+output = nil
+superinstructions = false
+mrubyc_dir = File.expand_path("../mrubyc", __dir__)
+OptionParser.new do |opt|
+  opt.on("-B NAME", "name of mrbc_prelinked. (<NAME>_prelinked)") { |v| name = v }
+  opt.on("-o FILE", "output file.") { |v| output = v }
+  opt.on("-s", "fuse superinstructions.") { superinstructions = true }
+  opt.on("-I DIR", "mruby/c source directory.") { |v| mrubyc_dir = v }
+  opt.parse!(ARGV)
+end
+input = ARGV[0] or abort "no input file."
+output ||= input.sub(/\.mrb\z/, "") + ".prelinked.c"
+
+# built-in symbol IDs.
+src = File.read(File.join(mrubyc_dir, "_autogen_builtin_symbol.h"))
+table = src[/builtin_symbols\[\] = \{(.*?)\};/m, 1] or abort "builtin_symbols not found."
+BUILTIN = {}
+table.scan(/^\s*"((?:[^"\\]|\\.)*)",/).each_with_index do |m, id|
+  BUILTIN[m[0].gsub(/\\(.)/, '\1')] = id
+end
+
+# opcodes and operand formats.
+OPS = {}
+FORMATS = {}
+File.read(File.join(mrubyc_dir, "opcode.h")).scan(/OP_(\w+)\s*=\s*0x(\h+),\s*\/\/!<\s*(\w+)/) do |n, code, fmt|
+  OPS[n.to_sym] = code.hex
+  FORMATS[code.hex] = fmt
+end
+
+
+Irep = Struct.new(:id, :nlocals, :nregs, :clen, :iseq, :pool, :plen,
+                  :syms, :children)
+
+# read one irep and its children. same as load_irep() in load.c
+def read_irep(bin, pos, ireps)
+  nlocals, nregs, rlen, clen, ilen = bin[pos + 4, 12].unpack("n4N")
+  p = pos + 16
+  iseq = bin[p, ilen + SIZE_RITE_CATCH_HANDLER * clen].bytes
+  p += iseq.size
+
+  # pool
+  pool_top = p
+  plen = bin[p, 2].unpack1("n")
+  p += 2
+  plen.times do
+    tt = bin.getbyte(p)
+    p += 1
+    case tt
+    when 0, 2 then p += bin[p, 2].unpack1("n") + 3	# string
+    when 1 then p += 4					# int32
+    when 3, 5 then p += 8				# int64, float
+    else abort "unknown pool type #{tt}."
+    end
+  end
+  pool = bin[pool_top...p].bytes
+
+  # symbols
+  slen = bin[p, 2].unpack1("n")
+  p += 2
+  syms = Array.new(slen) do
+    len = bin[p, 2].unpack1("n")
+    s = bin[p + 2, len]
+    p += 2 + len + 1
+    s
+  end
+
+  irep = Irep.new(0, nlocals, nregs, clen, iseq, pool, plen, syms, [])
+  len = bin[pos, 4].unpack1("N")
+  rlen.times do
+    child, clen2 = read_irep(bin, pos + len, ireps)
+    irep.children << child
+    len += clen2
+  end
+
+  # children first, so that C needs no forward declaration.
+  irep.id = ireps.size
+  ireps << irep
+  [irep, len]
+end
+
+def operand_size(op, ext)
+  ext_a = ext & 1
+  ext_b = (ext >> 1) & 1
+  case FORMATS[op]
+  when "Z" then 0
+  when "B" then 1 + ext_a
+  when "BB" then 2 + ext_a + ext_b
+  when "BBB" then 3 + ext_a + ext_b
+  when "BS" then 3 + ext_a
+  when "BSS" then 5 + ext_a
+  when "S" then 2
+  when "W" then 3
+  end
+end
+
+# same as fuse_sequence() in load.c
+def fuse_sequence(code, i, ilen)
+  op = code[i]
+  q = i + 1 + operand_size(op, 0)
+  case op
+  when OPS[:EQ], OPS[:LT], OPS[:LE], OPS[:GT], OPS[:GE]
+    return if q + 4 > ilen || code[q + 1] != code[i + 1]
+    if code[q] == OPS[:JMPIF]
+      code[i] = OPS[:EQ_JMPIF] + (op - OPS[:EQ]) * 2
+    elsif code[q] == OPS[:JMPNOT]
+      code[i] = OPS[:EQ_JMPNOT] + (op - OPS[:EQ]) * 2
+    end
+
+  when OPS[:LOADI16]
+    return if q + 2 > ilen || code[q] != OPS[:ADD] || code[i + 1] != code[q + 1] + 1
+    code[i] = OPS[:LOADI16_ADD]
+
+  when OPS[:GETIV]
+    r = q + 3
+    return if r + 3 > ilen || code[q] != OPS[:ADDI] || code[q + 1] != code[i + 1]
+    return if code[r] != OPS[:SETIV] || code[r + 1] != code[i + 1] || code[r + 2] != code[i + 2]
+    code[i] = OPS[:GETIV_ADDI_SETIV]
+
+  when OPS[:MOVE]
+    return if q + 4 > ilen || code[q] != OPS[:SEND]
+    code[i] = OPS[:MOVE_SEND]
+  end
+end
+
+# same as fuse_instructions() in load.c
+def fuse_instructions(code, ilen)
+  i = 0
+  ext = 0
+  while i < ilen
+    op = code[i]
+    siz = operand_size(op, ext)
+    return unless siz
+
+    if (OPS[:EXT1]..OPS[:EXT3]).include?(op)
+      ext = op - OPS[:EXT1] + 1
+      i += 1
+      next
+    end
+
+    fuse_sequence(code, i, ilen) if ext == 0
+    ext = 0
+    i += 1 + siz
+  end
+end
+
+
+bin = File.binread(input)
+abort "#{input}: Illegal bytecode." unless bin[0, 4] == "RITE"
+abort "#{input}: Bytecode version mismatch." unless bin[4, 4] == "0300"
+
+ireps = []
+pos = SIZE_RITE_BINARY_HEADER
+top = nil
+while pos < bin.size
+  case bin[pos, 4]
+  when "IREP"
+    top, = read_irep(bin, pos + SIZE_RITE_SECTION_HEADER, ireps)
+  when "END\0"
+    break
+  end
+  pos += bin[pos + 4, 4].unpack1("N")
+end
+abort "#{input}: IREP section not found." unless top
+
+# number the symbols. instance variable "@name" is also referred as "name".
+symbols = []
+symbol_ids = {}
+symid = lambda do |s|
+  BUILTIN[s] || symbol_ids[s] ||= begin
+    symbols << s
+    OFFSET_BUILTIN_SYMBOL + symbols.size - 1
+  end
+end
+ireps.each do |irep|
+  irep.syms.each do |s|
+    symid.(s)
+    symid.(s[1..]) if s.start_with?("@") && !s.start_with?("@@")
+  end
+end
+
+def c_array(values)
+  values.each_slice(16).map { |a| "  " + a.join(",") + "," }.join("\n")
+end
+
+def c_string(s)
+  '"' + s.bytes.map { |c|
+    (c == 0x22 || c == 0x5c) ? "\\" + c.chr :
+      (0x20..0x7e).include?(c) ? c.chr : format("\\%03o", c)
+  }.join + '"'
+end
+
+File.open(output, "w") do |f|
+  f.puts <<~EOS
+    /* Auto generated by mrbc_prelink.rb from #{File.basename(input)} */
+    #include "mrubyc/vm.h"
+    #include "mrubyc/load.h"
+
+  EOS
+
+  ireps.each do |irep|
+    n = irep.id
+    slen = irep.syms.size
+    fuse_instructions(irep.iseq, irep.iseq.size - SIZE_RITE_CATCH_HANDLER * irep.clen) if superinstructions
+
+    f.puts "static const uint8_t irep_#{n}_iseq[] = {\n#{c_array(irep.iseq)}\n};"
+    if irep.plen > 0
+      ofs = []
+      p = 2
+      irep.plen.times do
+        ofs << p
+        tt = irep.pool[p]
+        p += 1 + ((tt == 0 || tt == 2) ? (irep.pool[p + 1] << 8 | irep.pool[p + 2]) + 3 :
+                    tt == 1 ? 4 : 8)
+      end
+      f.puts "static const uint8_t irep_#{n}_pool[] = {\n#{c_array(irep.pool)}\n};"
+      f.puts "static const uint16_t irep_#{n}_pools[] = {\n#{c_array(ofs)}\n};"
+    end
+    if slen > 0
+      f.puts "static const mrbc_sym irep_#{n}_syms[] = {"
+      irep.syms.each { |s| f.puts "  #{symid.(s)},\t// #{c_string(s)}" }
+      irep.syms.each do |s|
+        ivar = s.start_with?("@") && !s.start_with?("@@")
+        f.puts "  #{ivar ? symid.(s[1..]) : -1},"
+      end
+      f.puts "};"
+      f.puts "static mrbc_irep_cache irep_#{n}_cache[#{slen}];"
+    end
+    unless irep.children.empty?
+      f.puts "static mrbc_irep * const irep_#{n}_reps[] = {"
+      irep.children.each { |c| f.puts "  (mrbc_irep *)&irep_#{c.id}," }
+      f.puts "};"
+    end
+
+    f.puts <<~EOS
+      static const mrbc_irep irep_#{n} = {
+      #if defined(MRBC_DEBUG)
+        .type = { 'R', 'P' },
+      #endif
+        .nlocals = #{irep.nlocals},
+        .nregs = #{irep.nregs},
+        .rlen = #{irep.children.size},
+        .clen = #{irep.clen},
+        .ilen = #{irep.iseq.size - SIZE_RITE_CATCH_HANDLER * irep.clen},
+        .plen = #{irep.plen},
+        .slen = #{slen},
+        .inst = irep_#{n}_iseq,
+        .pool = #{irep.plen > 0 ? "irep_#{n}_pool" : "0"},
+        .tbl_syms = #{slen > 0 ? "irep_#{n}_syms" : "0"},
+        .tbl_pools = #{irep.plen > 0 ? "irep_#{n}_pools" : "0"},
+        .tbl_ireps = #{irep.children.empty? ? "0" : "irep_#{n}_reps"},
+        .tbl_cache = #{slen > 0 ? "irep_#{n}_cache" : "0"},
+      };
+
+    EOS
+  end
+
+  unless symbols.empty?
+    f.puts "static const char * const #{name}_symbols[] = {"
+    symbols.each { |s| f.puts "  #{c_string(s)}," }
+    f.puts "};"
+  end
+  f.puts <<~EOS
+
+    const mrbc_prelinked #{name}_prelinked = {
+      &irep_#{top.id},
+      #{symbols.empty? ? "0" : "#{name}_symbols"},
+      #{symbols.size},
+      #{OFFSET_BUILTIN_SYMBOL},
+    };
+  EOS
+end
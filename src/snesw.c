@@ -1,7 +1,12 @@
 #include <snes.h>
+#include <string.h>
+
+#include "snesw.h"
 
 void snesw_pads_current(u16 *dst, u16 value) { *dst = padsCurrent(value); }
 
+void snesw_frame_count(u16 *dst) { *dst = snes_vblank_count; }
+
 void snesw_wait_and_dma_to_vram(const u8 *source, u16 address, u16 size) {
   // DMAはVBlank中でないと動作しない
   WaitForVBlank();
@@ -9,3 +14,55 @@ void snesw_wait_and_dma_to_vram(const u8 *source, u16 address, u16 size) {
   // TODO: VBlankを待ってるので多分DMA使わずにコピーしたほうが高速
   dmaCopyVram(source, address, size);
 }
+
+// Uploads all the spans in a VBlank.
+void snesw_wait_and_dma_spans_to_vram(const snesw_vram_span *spans, u16 n) {
+  WaitForVBlank();
+
+  u16 i;
+  for (i = 0; i < n; i++) {
+    dmaCopyVram(spans[i].source, spans[i].address, spans[i].size);
+  }
+}
+
+static snesw_ring *ring;
+static snesw_oam *oam;
+
+void snesw_ring_attach(snesw_ring *r) { ring = r; }
+
+void snesw_oam_attach(snesw_oam *o) { oam = o; }
+
+// Runs the commands queued by SA-1. Only S-CPU advances the tail, so the
+// entry stays untouched until it has been run.
+void snesw_ring_drain(void) {
+  if (ring == NULL) {
+    return;
+  }
+
+  while (ring->tail != ring->head) {
+    const volatile snesw_command *c =
+        &ring->commands[ring->tail & (SNESW_RING_SIZE - 1)];
+
+    switch (c->id) {
+      case SNESW_COMMAND_BG_SCROLL:
+        bgSetScroll(c->b[0], c->w[0], c->w[1]);
+        break;
+      case SNESW_COMMAND_SPC_PROCESS:
+        spcProcess();
+        break;
+      case SNESW_COMMAND_SPC_PLAY_SOUND:
+        spcPlaySound(c->b[0]);
+        break;
+      case SNESW_COMMAND_SCAN_PADS:
+        scanPads();
+        break;
+      case SNESW_COMMAND_OAM_UPDATE:
+        // out of NMI. pvsneslib uploads oamMemory in the next VBlank.
+        memcpy(oamMemory, oam->memory, SNESW_OAM_SIZE);
+        break;
+    }
+
+    ring->tail++;
+  }
+}
+
@@ -4,6 +4,58 @@
 #include <snes.h>
 
 void snesw_pads_current(u16 *dst, u16 value);
+void snesw_frame_count(u16 *dst);
 void snesw_wait_and_dma_to_vram(const u8 *source, u16 address, u16 size);
 
+typedef struct {
+  const u8 *source;
+  u16 address;
+  u16 size;
+} snesw_vram_span;
+
+void snesw_wait_and_dma_spans_to_vram(const snesw_vram_span *spans, u16 n);
+
+// Commands which SA-1 sends to S-CPU through the ring without waiting.
+enum {
+  SNESW_COMMAND_BG_SCROLL,        // bgSetScroll(b0, w0, w1)
+  SNESW_COMMAND_SPC_PROCESS,      // spcProcess()
+  SNESW_COMMAND_SPC_PLAY_SOUND,   // spcPlaySound(b0)
+  SNESW_COMMAND_SCAN_PADS,        // scanPads()
+  SNESW_COMMAND_OAM_UPDATE,       // copy the shadow OAM to oamMemory
+};
+
+typedef struct {
+  u8 id;
+  u8 b[4];
+  u16 w[4];
+} snesw_command;
+
+// must be a power of 2, up to 256.
+#define SNESW_RING_SIZE 16
+
+// Single producer (SA-1), single consumer (S-CPU) ring in BW-RAM.
+// head and tail run freely, and are masked to index the commands.
+// The commands are volatile too, so that the compiler doesn't move the
+// stores of a command after the store of head which publishes it.
+typedef struct {
+  volatile u8 head;  // written only by SA-1.
+  volatile u8 tail;  // written only by S-CPU.
+  volatile snesw_command commands[SNESW_RING_SIZE];
+} snesw_ring;
+
+void snesw_ring_attach(snesw_ring *ring);
+void snesw_ring_drain(void);
+
+// 128 sprites of 4 bytes, and 2 bits of each sprite in the high table.
+#define SNESW_OAM_SIZE (128 * 4 + 128 / 4)
+
+// Shadow OAM in BW-RAM, written by SA-1. SNESW_COMMAND_OAM_UPDATE copies
+// it to oamMemory of pvsneslib, which uploads oamMemory in VBlank.
+typedef struct {
+  u8 dirty;  // changed since the last SNESW_COMMAND_OAM_UPDATE.
+  u8 memory[SNESW_OAM_SIZE];
+} snesw_oam;
+
+void snesw_oam_attach(snesw_oam *oam);
+
 #endif